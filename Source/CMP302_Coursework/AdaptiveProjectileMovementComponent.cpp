@@ -0,0 +1,208 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AdaptiveProjectileMovementComponent.h"
+
+#include "ProjectileSweepBudgetSubsystem.h"
+#include "Components/PrimitiveComponent.h"
+#include "Misc/ScopeExit.h"
+
+FProjectileQueryStats UAdaptiveProjectileMovementComponent::QueryStats;
+bool UAdaptiveProjectileMovementComponent::bCollectQueryStats = false;
+
+namespace
+{
+	/** Gap left between a projectile and the surface it stopped against */
+	constexpr float HitPullBackDistance = 0.1f;
+}
+
+void UAdaptiveProjectileMovementComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	const uint64 StartCycles = bCollectQueryStats ? FPlatformTime::Cycles64() : 0;
+	ON_SCOPE_EXIT
+	{
+		if(StartCycles != 0)
+			QueryStats.TickCycles += FPlatformTime::Cycles64() - StartCycles;
+	};
+	
+	if(!bUseAdaptiveCollision) {
+		Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+		return;
+	}
+	
+	// Skip the stock projectile movement, but keep what the base movement component does
+	UMovementComponent::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	
+	if(!IsValid(UpdatedComponent) || !bSimulationEnabled || ShouldSkipUpdate(DeltaTime))
+		return;
+	
+	AActor* ActorOwner = UpdatedComponent->GetOwner();
+	if(!IsValid(ActorOwner) || !CheckStillInWorld() || UpdatedComponent->IsSimulatingPhysics())
+		return;
+	
+	const float Radius = UpdatedPrimitive != nullptr ? UpdatedPrimitive->GetCollisionShape().GetSphereRadius() : 0.f;
+	const bool bUseRay = Radius <= RayRadius;
+	
+	// Time left over from running out of sweeps last frame, which also puts this projectile first for them
+	const bool bStarved = DeferredTime > 0.f;
+	UProjectileSweepBudgetSubsystem* SweepBudget = GetWorld()->GetSubsystem<UProjectileSweepBudgetSubsystem>();
+	float RemainingTime = DeltaTime + DeferredTime;
+	DeferredTime = 0;
+	
+	for(int32 Iterations = 0; RemainingTime > UE_KINDA_SMALL_NUMBER && Iterations < MaxSimulationIterations; ) {
+		Iterations++;
+		
+		// Substeps match the stock component, so a fast or falling projectile doesn't cut corners
+		const float TimeTick = ShouldUseSubStepping() ? GetSimulationTimeStep(RemainingTime, Iterations) : RemainingTime;
+		
+		const FVector OldVelocity = Velocity;
+		const FVector Start = UpdatedComponent->GetComponentLocation();
+		const FVector End = Start + ComputeMoveDelta(OldVelocity, TimeTick);
+		
+		FHitResult Hit(1.f);
+		bool bHit = false;
+		
+		if(IsInsideVerifiedSpace(End)) {
+			QueryStats.NumSkipped++;
+		}
+		else if(SweepBudget != nullptr && !SweepBudget->ConsumeSweep(bStarved)) {
+			// Out of queries for this frame, catch up next frame rather than move blind.
+			// Only one step's worth is kept, a projectile starved for several frames loses the rest.
+			QueryStats.NumDeferred++;
+			DeferredTime = FMath::Min(RemainingTime, MaxSimulationTimeStep);
+			SweepBudget->MarkStarved();
+			break;
+		}
+		else {
+			bHit = QueryMove(Start, End, bUseRay ? 0.f : Radius, Hit);
+		}
+		
+		const float TimeTaken = bHit ? TimeTick * Hit.Time : TimeTick;
+		Velocity = ComputeVelocity(OldVelocity, TimeTaken);
+		RemainingTime -= TimeTaken;
+		
+		// Stop just short of the surface, so the next query doesn't start touching it.
+		// A trace hit is on the surface, so step back the whole radius.
+		FVector NewLocation = End;
+		if(bHit)
+			NewLocation = bUseRay ? Hit.Location + Hit.ImpactNormal * (Radius + HitPullBackDistance) : Hit.Location + Hit.Normal * HitPullBackDistance;
+		
+		const FQuat NewRotation = bRotationFollowsVelocity && !Velocity.IsNearlyZero() ? Velocity.ToOrientationQuat() : UpdatedComponent->GetComponentQuat();
+		UpdatedComponent->SetWorldLocationAndRotation(NewLocation, NewRotation, false, nullptr, ETeleportType::None);
+		
+		if(!bHit)
+			continue;
+		
+		// Space ahead changed direction, what was verified no longer lies on the path
+		bHasVerifiedSpace = false;
+		
+		if(UpdatedPrimitive != nullptr)
+			UpdatedPrimitive->DispatchBlockingHit(*ActorOwner, Hit);
+		
+		// OnHit may have destroyed the projectile
+		if(!IsValid(ActorOwner) || !IsValid(UpdatedComponent) || HasStoppedSimulation())
+			return;
+		
+		if(!bShouldBounce || ++NumBounces > MaxBounces) {
+			StopSimulating(Hit);
+			return;
+		}
+		
+		Bounce(Hit);
+		
+		if(HasStoppedSimulation())
+			return;
+	}
+	
+	UpdateComponentVelocity();
+}
+
+bool UAdaptiveProjectileMovementComponent::MoveUpdatedComponentImpl(const FVector& Delta, const FQuat& NewRotation, bool bSweep, FHitResult* OutHit, ETeleportType Teleport)
+{
+	// The adaptive path places the component itself, so everything through here is the stock movement
+	if(bSweep && !Delta.IsNearlyZero())
+		QueryStats.NumStockSweeps++;
+	
+	return Super::MoveUpdatedComponentImpl(Delta, NewRotation, bSweep, OutHit, Teleport);
+}
+
+bool UAdaptiveProjectileMovementComponent::QueryMove(const FVector& Start, const FVector& End, float Radius, FHitResult& OutHit)
+{
+	UWorld* const World = GetWorld();
+	
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(AdaptiveProjectileMove), false, UpdatedComponent->GetOwner());
+	FCollisionResponseParams ResponseParams;
+	if(UpdatedPrimitive != nullptr)
+		UpdatedPrimitive->InitSweepCollisionParams(QueryParams, ResponseParams);
+	
+	const ECollisionChannel Channel = UpdatedComponent->GetCollisionObjectType();
+	
+	// Starting against a surface reads as a hit at time 0, which only matters when moving into it
+	auto IsBlockingHit = [&Start, &End](bool bHit, const FHitResult& Hit)
+	{
+		return bHit && !(Hit.bStartPenetrating && (Hit.Normal | (End - Start)) > 0.f);
+	};
+	
+	if(Radius <= 0.f) {
+		QueryStats.NumRays++;
+		return IsBlockingHit(World->LineTraceSingleByChannel(OutHit, Start, End, Channel, QueryParams, ResponseParams), OutHit);
+	}
+	
+	const FVector Delta = End - Start;
+	const float MoveDistance = Delta.Size();
+	const float LookAheadDistance = Velocity.Size() * VerifiedLookAheadTime;
+	
+	// One padded sweep far ahead, so the next few moves don't need a query at all
+	if(LookAheadDistance > MoveDistance && MoveDistance > UE_KINDA_SMALL_NUMBER) {
+		QueryStats.NumSweeps++;
+		
+		const FVector Direction = Delta / MoveDistance;
+		const FVector LookAheadEnd = Start + Direction * LookAheadDistance;
+		
+		FHitResult LookAheadHit;
+		const bool bLookAheadHit = World->SweepSingleByChannel(LookAheadHit, Start, LookAheadEnd, FQuat::Identity, Channel,
+			FCollisionShape::MakeSphere(Radius + VerifiedSpaceTolerance), QueryParams, ResponseParams);
+		
+		const float ClearDistance = bLookAheadHit ? LookAheadHit.Distance : LookAheadDistance;
+		if(ClearDistance > MoveDistance) {
+			VerifiedStart = Start;
+			VerifiedEnd = Start + Direction * ClearDistance;
+			VerifiedUntil = World->GetTimeSeconds() + VerifiedLookAheadTime;
+			bHasVerifiedSpace = true;
+			
+			return false;
+		}
+		
+		// The padded sweep can hit things the projectile would just miss, so check this move exactly.
+		// This second sweep isn't taken from the budget, a move is never left half checked.
+	}
+	
+	QueryStats.NumSweeps++;
+	return IsBlockingHit(World->SweepSingleByChannel(OutHit, Start, End, FQuat::Identity, Channel, FCollisionShape::MakeSphere(Radius), QueryParams, ResponseParams), OutHit);
+}
+
+bool UAdaptiveProjectileMovementComponent::IsInsideVerifiedSpace(const FVector& Location) const
+{
+	if(!bHasVerifiedSpace || GetWorld()->GetTimeSeconds() > VerifiedUntil)
+		return false;
+	
+	// Anything that moved into the tube since it was swept is missed, which is why it expires
+	const FVector ClosestPoint = FMath::ClosestPointOnSegment(Location, VerifiedStart, VerifiedEnd);
+	return FVector::DistSquared(ClosestPoint, Location) <= FMath::Square(VerifiedSpaceTolerance) && ClosestPoint != VerifiedEnd;
+}
+
+void UAdaptiveProjectileMovementComponent::Bounce(const FHitResult& Hit)
+{
+	const FVector OldVelocity = Velocity;
+	
+	// The stock response, so friction and bounce angle settings behave the same as UProjectileMovementComponent
+	Velocity = ComputeBounceVelocity(Velocity, Hit);
+	
+	OnProjectileBounce.Broadcast(Hit, OldVelocity);
+	
+	// The bounce event may have changed the velocity
+	Velocity = LimitVelocity(Velocity);
+	
+	if(Velocity.SizeSquared() < FMath::Square(BounceVelocityStopSimulatingThreshold))
+		StopSimulating(Hit);
+}
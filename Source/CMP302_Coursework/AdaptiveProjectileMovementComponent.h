@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "AdaptiveProjectileMovementComponent.generated.h"
+
+/** Collision queries made by projectiles, reset by whoever is measuring them */
+struct FProjectileQueryStats
+{
+	uint64 NumSweeps = 0;
+	uint64 NumRays = 0;
+	/** Moves that stayed inside space already verified empty and needed no query */
+	uint64 NumSkipped = 0;
+	/** Moves put off to the next frame because the sweep budget ran out */
+	uint64 NumDeferred = 0;
+	/** Sweeping moves made by the stock component, including slides and penetration fixes */
+	uint64 NumStockSweeps = 0;
+	/** Only added to while bCollectQueryStats is set */
+	uint64 TickCycles = 0;
+
+	uint64 GetNumQueries() const { return NumSweeps + NumRays + NumStockSweeps; }
+};
+
+/**
+ * Projectile movement that picks the cheapest collision query that is
+ * still correct for each move:
+ *
+ * - Projectiles with a radius under RayRadius use a line trace instead of a sphere sweep.
+ * - A sweep looks ahead VerifiedLookAheadTime along the flight path with the radius
+ *   padded by VerifiedSpaceTolerance. While the projectile stays inside that empty
+ *   tube it moves without querying at all.
+ * - Moves are made without sweeping the component, and bounces are only worked out
+ *   when a query actually hits something.
+ *
+ * Fast or falling projectiles are split into substeps the same way as the stock
+ * component, so the look ahead usually covers several of them with one sweep.
+ * MaxBounces and the world's UProjectileSweepBudgetSubsystem bound the work. Turn bUseAdaptiveCollision off to
+ * fall back to the stock UProjectileMovementComponent, which CMP302.ProjectileBench
+ * uses for comparison.
+ */
+UCLASS(ClassGroup=Movement, meta=(BlueprintSpawnableComponent))
+class CMP302_COURSEWORK_API UAdaptiveProjectileMovementComponent : public UProjectileMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+protected:
+	/** Counts the sweeps made by the stock movement */
+	virtual bool MoveUpdatedComponentImpl(const FVector& Delta, const FQuat& NewRotation, bool bSweep, FHitResult* OutHit = nullptr, ETeleportType Teleport = ETeleportType::None) override;
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Adaptive Collision")
+	bool bUseAdaptiveCollision = true;
+
+	/** Collision radius below which a line trace is used instead of a sphere sweep */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Adaptive Collision", meta=(ClampMin="0"))
+	float RayRadius = 2.0f;
+
+	/** How far ahead, in seconds of flight, each sweep checks for empty space */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Adaptive Collision", meta=(ClampMin="0"))
+	float VerifiedLookAheadTime = 0.1f;
+
+	/** How far the projectile may drift off the swept line, from gravity, and still count as inside it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Adaptive Collision", meta=(ClampMin="0"))
+	float VerifiedSpaceTolerance = 10.0f;
+
+	/** Bounces before the projectile stops, only used when bShouldBounce is set */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Adaptive Collision", meta=(ClampMin="0"))
+	int32 MaxBounces = 3;
+
+	static FProjectileQueryStats QueryStats;
+
+	/** Set while something is measuring, ticks are only timed then */
+	static bool bCollectQueryStats;
+
+private:
+	/** Checks the move for blocking hits, returns true and fills OutHit if there was one */
+	bool QueryMove(const FVector& Start, const FVector& End, float Radius, FHitResult& OutHit);
+
+	bool IsInsideVerifiedSpace(const FVector& Location) const;
+
+	void Bounce(const FHitResult& Hit);
+
+	FVector VerifiedStart = FVector::ZeroVector;
+	FVector VerifiedEnd = FVector::ZeroVector;
+	double VerifiedUntil = 0;
+	bool bHasVerifiedSpace = false;
+
+	/** Time not simulated yet because the sweep budget ran out, at most MaxSimulationTimeStep */
+	float DeferredTime = 0;
+	int32 NumBounces = 0;
+};
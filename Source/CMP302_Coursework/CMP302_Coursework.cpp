@@ -1,7 +1,57 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "CMP302_Coursework.h"
+#include "CombatTelemetry.h"
 #include "Modules/ModuleManager.h"
+#include "Engine/World.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, CMP302_Coursework, "CMP302_Coursework" );
- 
\ No newline at end of file
+class FCMP302_CourseworkModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+		// -CombatTelemetry records to the default file, -CombatTelemetry=<File> to the given one
+		FString Filename;
+		if (FParse::Value(FCommandLine::Get(), TEXT("CombatTelemetry="), Filename))
+		{
+			FCombatTelemetry::StartRecording(Filename);
+		}
+		else if (FParse::Param(FCommandLine::Get(), TEXT("CombatTelemetry")))
+		{
+			FCombatTelemetry::StartRecording(FCombatTelemetry::GetDefaultFilename());
+		}
+	}
+
+	virtual void ShutdownModule() override
+	{
+		FCombatTelemetry::StopRecording();
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FCMP302_CourseworkModule, CMP302_Coursework, "CMP302_Coursework" );
+
+DEFINE_LOG_CATEGORY(LogCMP302);
+
+LLM_DEFINE_TAG(CMP302_Turrets, TEXT("CMP302 Turrets"));
+LLM_DEFINE_TAG(CMP302_Projectiles, TEXT("CMP302 Projectiles"));
+LLM_DEFINE_TAG(CMP302_Weapons, TEXT("CMP302 Weapons"));
+
+static TAutoConsoleVariable<bool> CVarStripCosmetics(
+	TEXT("CMP302.StripCosmetics"),
+	false,
+	TEXT("Skip sounds, animations and projectile meshes as if running as a dedicated server."));
+
+bool CMP302::ShouldPlayCosmetics(const UObject* WorldContextObject)
+{
+#if UE_SERVER
+	return false;
+#else
+	if (CVarStripCosmetics.GetValueOnGameThread())
+	{
+		return false;
+	}
+
+	const UWorld* World = WorldContextObject != nullptr ? WorldContextObject->GetWorld() : nullptr;
+	return World == nullptr || World->GetNetMode() != NM_DedicatedServer;
+#endif
+}
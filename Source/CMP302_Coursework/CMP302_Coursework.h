@@ -3,3 +3,17 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogCMP302, Log, All);
+
+/** Low level memory tracker tags, see them with -llm and "stat LLMFULL" */
+LLM_DECLARE_TAG_API(CMP302_Turrets, CMP302_COURSEWORK_API);
+LLM_DECLARE_TAG_API(CMP302_Projectiles, CMP302_COURSEWORK_API);
+LLM_DECLARE_TAG_API(CMP302_Weapons, CMP302_COURSEWORK_API);
+
+namespace CMP302
+{
+	/** False on dedicated servers (or with CMP302.StripCosmetics set), where sounds, animations and meshes are never seen */
+	CMP302_COURSEWORK_API bool ShouldPlayCosmetics(const UObject* WorldContextObject);
+}
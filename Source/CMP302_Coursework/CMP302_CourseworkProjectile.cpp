@@ -1,11 +1,16 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "CMP302_CourseworkProjectile.h"
-#include "GameFramework/ProjectileMovementComponent.h"
+#include "CMP302_Coursework.h"
+#include "CombatTelemetry.h"
+#include "AdaptiveProjectileMovementComponent.h"
 #include "Components/SphereComponent.h"
+#include "Components/MeshComponent.h"
 
 ACMP302_CourseworkProjectile::ACMP302_CourseworkProjectile() 
 {
+	LLM_SCOPE_BYTAG(CMP302_Projectiles);
+
 	// Use a sphere as a simple collision representation
 	CollisionComp = CreateDefaultSubobject<USphereComponent>(TEXT("SphereComp"));
 	CollisionComp->InitSphereRadius(5.0f);
@@ -19,8 +24,8 @@ ACMP302_CourseworkProjectile::ACMP302_CourseworkProjectile()
 	// Set as root component
 	RootComponent = CollisionComp;
 
-	// Use a ProjectileMovementComponent to govern this projectile's movement
-	ProjectileMovement = CreateDefaultSubobject<UProjectileMovementComponent>(TEXT("ProjectileComp"));
+	// Use a ProjectileMovementComponent to govern this projectile's movement, picking the cheapest collision query per move
+	ProjectileMovement = CreateDefaultSubobject<UAdaptiveProjectileMovementComponent>(TEXT("ProjectileComp"));
 	ProjectileMovement->UpdatedComponent = CollisionComp;
 	ProjectileMovement->InitialSpeed = 3000.f;
 	ProjectileMovement->MaxSpeed = 3000.f;
@@ -31,10 +36,33 @@ ACMP302_CourseworkProjectile::ACMP302_CourseworkProjectile()
 	InitialLifeSpan = 3.0f;
 }
 
+void ACMP302_CourseworkProjectile::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	FCombatTelemetry::Record(ECombatEventType::ProjectileSpawn, GetActorLocation(), GetUniqueID());
+
+	if (CMP302::ShouldPlayCosmetics(this))
+	{
+		return;
+	}
+
+	// Meshes only exist to be seen, the server just needs the sphere to collide with
+	TInlineComponentArray<UMeshComponent*> MeshComponents(this);
+	for (UMeshComponent* MeshComponent : MeshComponents)
+	{
+		MeshComponent->DestroyComponent();
+	}
+}
+
 void ACMP302_CourseworkProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
 {
 	// Only add impulse and destroy projectile if we hit a physics
-	if ((OtherActor != nullptr) && (OtherActor != this) && (OtherComp != nullptr) && OtherComp->IsSimulatingPhysics())
+	const bool bHitPhysicsBody = (OtherActor != nullptr) && (OtherActor != this) && (OtherComp != nullptr) && OtherComp->IsSimulatingPhysics();
+
+	FCombatTelemetry::Record(ECombatEventType::ProjectileHit, Hit.ImpactPoint, GetUniqueID(), bHitPhysicsBody ? 1.f : 0.f);
+
+	if (bHitPhysicsBody)
 	{
 		OtherComp->AddImpulseAtLocation(GetVelocity() * 100.0f, GetActorLocation());
 
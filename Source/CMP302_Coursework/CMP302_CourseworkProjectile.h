@@ -25,6 +25,9 @@ class ACMP302_CourseworkProjectile : public AActor
 public:
 	ACMP302_CourseworkProjectile();
 
+	/** Strips the blueprint meshes on dedicated servers, leaving only the collision sphere */
+	virtual void PostInitializeComponents() override;
+
 	/** called when projectile hits something */
 	UFUNCTION()
 	void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
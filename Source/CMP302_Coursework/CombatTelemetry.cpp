@@ -0,0 +1,224 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatTelemetry.h"
+
+#include "CMP302_Coursework.h"
+#include "RenderCore.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/App.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/Paths.h"
+
+FCombatTelemetry* FCombatTelemetry::Instance = nullptr;
+
+static FAutoConsoleCommand TelemetryCommand(
+	TEXT("CMP302.Telemetry"),
+	TEXT("Start [File] begins recording combat events to a binary file, Stop finishes the file."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (Args.Num() > 0 && Args[0].Equals(TEXT("Stop"), ESearchCase::IgnoreCase))
+		{
+			FCombatTelemetry::StopRecording();
+		}
+		else if (Args.Num() > 0 && Args[0].Equals(TEXT("Start"), ESearchCase::IgnoreCase))
+		{
+			FCombatTelemetry::StartRecording(Args.Num() > 1 ? Args[1] : FCombatTelemetry::GetDefaultFilename());
+		}
+	}));
+
+const TCHAR* LexToString(ECombatEventType Type)
+{
+	switch (Type)
+	{
+	case ECombatEventType::Frame:			return TEXT("Frame");
+	case ECombatEventType::TurretShot:		return TEXT("TurretShot");
+	case ECombatEventType::PlayerShot:		return TEXT("PlayerShot");
+	case ECombatEventType::ProjectileHit:	return TEXT("ProjectileHit");
+	case ECombatEventType::ProjectileSpawn:	return TEXT("ProjectileSpawn");
+	case ECombatEventType::TurretSpawn:		return TEXT("TurretSpawn");
+	case ECombatEventType::GrappleStart:	return TEXT("GrappleStart");
+	case ECombatEventType::GrappleStop:		return TEXT("GrappleStop");
+	default:								return TEXT("Unknown");
+	}
+}
+
+FString FCombatTelemetry::GetDefaultFilename()
+{
+	return FPaths::ProfilingDir() / TEXT("CMP302") / FString::Printf(TEXT("CombatTelemetry-%s.bin"), *FDateTime::Now().ToString());
+}
+
+bool FCombatTelemetry::StartRecording(const FString& Filename)
+{
+	check(IsInGameThread());
+	
+	if (Instance != nullptr)
+	{
+		return false;
+	}
+	
+	FArchive* File = IFileManager::Get().CreateFileWriter(*Filename);
+	if (File == nullptr)
+	{
+		UE_LOG(LogCMP302, Warning, TEXT("Couldn't open %s for combat telemetry"), *Filename);
+		return false;
+	}
+	
+	FCombatTelemetryHeader Header = { FileMagic, FileVersion, sizeof(FCombatEvent), 0 };
+	File->Serialize(&Header, sizeof(Header));
+	
+	Instance = new FCombatTelemetry(File);
+	
+	UE_LOG(LogCMP302, Display, TEXT("Recording combat telemetry to %s"), *Filename);
+	return true;
+}
+
+void FCombatTelemetry::StopRecording()
+{
+	check(IsInGameThread());
+	
+	// Clear the instance first so nothing pushes while the writer finishes
+	FCombatTelemetry* Recorder = Instance;
+	Instance = nullptr;
+	
+	delete Recorder;
+}
+
+FCombatTelemetry::FCombatTelemetry(FArchive* InFile)
+	: File(InFile)
+{
+	Buffer.SetNumUninitialized(Capacity);
+	StartTime = FPlatformTime::Seconds();
+	
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool();
+	Thread = FRunnableThread::Create(this, TEXT("CombatTelemetryWriter"), 0, TPri_BelowNormal);
+	
+	// A frame record after every frame, so events can be lined up with frame times
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddRaw(this, &FCombatTelemetry::OnEndFrame);
+}
+
+FCombatTelemetry::~FCombatTelemetry()
+{
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	
+	if (Thread != nullptr)
+	{
+		Thread->Kill(true);
+		delete Thread;
+	}
+	
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	
+	File->Close();
+	
+	if (NumDropped > 0)
+	{
+		UE_LOG(LogCMP302, Warning, TEXT("Combat telemetry dropped %u events, the writer couldn't keep up"), NumDropped.load());
+	}
+}
+
+uint32 FCombatTelemetry::Run()
+{
+	while (!bStopping)
+	{
+		WakeEvent->Wait(50);
+		Flush();
+	}
+	
+	// Whatever was pushed before stopping
+	Flush();
+	return 0;
+}
+
+void FCombatTelemetry::Stop()
+{
+	bStopping = true;
+	WakeEvent->Trigger();
+}
+
+void FCombatTelemetry::Push(ECombatEventType Type, const FVector& Location, uint32 ObjectId, float Value, uint64 FrameNumber)
+{
+	checkSlow(IsInGameThread());
+	
+	const uint32 CurrentHead = Head.load(std::memory_order_relaxed);
+	const uint32 Used = CurrentHead - Tail.load(std::memory_order_acquire);
+	
+	if (Used >= Capacity)
+	{
+		NumDropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	
+	FCombatEvent& Event = Buffer[CurrentHead & (Capacity - 1)];
+	Event.FrameNumber = static_cast<uint32>(FrameNumber);
+	Event.Time = static_cast<float>(FPlatformTime::Seconds() - StartTime);
+	Event.Location = FVector3f(Location);
+	Event.Value = Value;
+	Event.ObjectId = ObjectId;
+	Event.Type = Type;
+	Event.Padding = 0;
+	
+	Head.store(CurrentHead + 1, std::memory_order_release);
+	
+	// Don't wait for the timeout when the buffer is filling up
+	if (Used == Capacity / 2)
+	{
+		WakeEvent->Trigger();
+	}
+}
+
+void FCombatTelemetry::Flush()
+{
+	const uint32 CurrentHead = Head.load(std::memory_order_acquire);
+	uint32 CurrentTail = Tail.load(std::memory_order_relaxed);
+	
+	while (CurrentTail != CurrentHead)
+	{
+		// Write up to the end of the buffer, then wrap around for the rest
+		const uint32 Start = CurrentTail & (Capacity - 1);
+		const uint32 Count = FMath::Min(CurrentHead - CurrentTail, Capacity - Start);
+		
+		File->Serialize(&Buffer[Start], Count * sizeof(FCombatEvent));
+		
+		CurrentTail += Count;
+		Tail.store(CurrentTail, std::memory_order_release);
+	}
+}
+
+void FCombatTelemetry::OnEndFrame()
+{
+	// The engine has already moved GFrameCounter on to the next frame by the time this is broadcast
+	Push(ECombatEventType::Frame, FVector::ZeroVector, static_cast<uint32>(FPlatformTime::ToMilliseconds(GGameThreadTime) * 1000.0f), FApp::GetDeltaTime() * 1000.0f, GFrameCounter - 1);
+}
+
+bool FCombatTelemetry::ReadFile(const FString& Filename, TArray<FCombatEvent>& OutEvents)
+{
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Filename));
+	if (!Reader.IsValid())
+	{
+		return false;
+	}
+	
+	// Too short to hold a header, so it isn't a telemetry file
+	if (Reader->TotalSize() < static_cast<int64>(sizeof(FCombatTelemetryHeader)))
+	{
+		return false;
+	}
+	
+	FCombatTelemetryHeader Header = {};
+	Reader->Serialize(&Header, sizeof(Header));
+	
+	if (Header.Magic != FileMagic || Header.Version != FileVersion || Header.EventSize != sizeof(FCombatEvent))
+	{
+		return false;
+	}
+	
+	// A recording cut short can end part way through an event, skip that one
+	const int64 NumEvents = (Reader->TotalSize() - sizeof(Header)) / sizeof(FCombatEvent);
+	OutEvents.SetNumUninitialized(NumEvents);
+	Reader->Serialize(OutEvents.GetData(), NumEvents * sizeof(FCombatEvent));
+	
+	return !Reader->IsError();
+}
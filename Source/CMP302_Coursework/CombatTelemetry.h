@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CoreGlobals.h"
+#include "HAL/Runnable.h"
+#include <atomic>
+
+class FArchive;
+class FRunnableThread;
+
+enum class ECombatEventType : uint16
+{
+	/** End of a frame, FrameNumber is the frame that ended, Value its time in ms and ObjectId the game thread time in microseconds */
+	Frame,
+	TurretShot,
+	PlayerShot,
+	/** Value is 1 when the projectile hit a physics body and was destroyed */
+	ProjectileHit,
+	ProjectileSpawn,
+	TurretSpawn,
+	GrappleStart,
+	GrappleStop
+};
+
+CMP302_COURSEWORK_API const TCHAR* LexToString(ECombatEventType Type);
+
+/** One record in the telemetry file, fixed size so a file can be read straight back into an array */
+struct FCombatEvent
+{
+	uint32 FrameNumber;
+	/** Seconds since recording started */
+	float Time;
+	FVector3f Location;
+	float Value;
+	uint32 ObjectId;
+	ECombatEventType Type;
+	uint16 Padding;
+};
+
+static_assert(sizeof(FCombatEvent) == 32, "FCombatEvent is written to disk as is, keep it 32 bytes");
+
+/** Start of every telemetry file */
+struct FCombatTelemetryHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	uint32 EventSize;
+	uint32 Reserved;
+};
+
+/**
+ * Records combat events into a fixed size lock-free ring buffer which
+ * a background thread streams to a binary file. Events are pushed from
+ * the game thread only, the writer thread is the only reader, so the
+ * buffer just needs an atomic head and tail. If the writer falls behind
+ * events are dropped and counted rather than blocking the game.
+ *
+ * Start with -CombatTelemetry[=File] or "CMP302.Telemetry Start [File]",
+ * and convert the file with the CombatTelemetry commandlet.
+ */
+class CMP302_COURSEWORK_API FCombatTelemetry : public FRunnable
+{
+public:
+	static constexpr uint32 FileMagic = 0x54504D43; // "CMPT"
+	static constexpr uint32 FileVersion = 1;
+
+	static bool StartRecording(const FString& Filename);
+	static void StopRecording();
+	static bool IsRecording() { return Instance != nullptr; }
+
+	/** Adds an event, does nothing when not recording */
+	static void Record(ECombatEventType Type, const FVector& Location, uint32 ObjectId = 0, float Value = 0.f)
+	{
+		if (Instance != nullptr)
+		{
+			Instance->Push(Type, Location, ObjectId, Value, GFrameCounter);
+		}
+	}
+
+	/** Reads every event back from a file written by the recorder */
+	static bool ReadFile(const FString& Filename, TArray<FCombatEvent>& OutEvents);
+
+	static FString GetDefaultFilename();
+
+	virtual ~FCombatTelemetry() override;
+
+	// FRunnable interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	// End of FRunnable interface
+
+private:
+	explicit FCombatTelemetry(FArchive* InFile);
+
+	void Push(ECombatEventType Type, const FVector& Location, uint32 ObjectId, float Value, uint64 FrameNumber);
+
+	/** Writes everything between the tail and head to the file, writer thread only */
+	void Flush();
+
+	void OnEndFrame();
+
+	/** Power of two so wrapping is a mask, 2 MB of events */
+	static constexpr uint32 Capacity = 1 << 16;
+
+	static FCombatTelemetry* Instance;
+
+	TArray<FCombatEvent> Buffer;
+	std::atomic<uint32> Head { 0 };
+	std::atomic<uint32> Tail { 0 };
+	std::atomic<uint32> NumDropped { 0 };
+	std::atomic<bool> bStopping { false };
+
+	TUniquePtr<FArchive> File;
+	FRunnableThread* Thread = nullptr;
+	FEvent* WakeEvent = nullptr;
+	double StartTime = 0;
+	FDelegateHandle EndFrameHandle;
+};
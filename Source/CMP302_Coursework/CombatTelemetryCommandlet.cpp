@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatTelemetryCommandlet.h"
+
+#include "CMP302_Coursework.h"
+#include "CombatTelemetry.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+UCombatTelemetryCommandlet::UCombatTelemetryCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UCombatTelemetryCommandlet::Main(const FString& Params)
+{
+	FString InFile;
+	if (!FParse::Value(*Params, TEXT("In="), InFile))
+	{
+		UE_LOG(LogCMP302, Error, TEXT("Usage: -run=CombatTelemetry -In=<File> [-Out=<File>] [-Format=csv|json]"));
+		return 1;
+	}
+	
+	FString Format = TEXT("csv");
+	FParse::Value(*Params, TEXT("Format="), Format);
+	const bool bJson = Format.Equals(TEXT("json"), ESearchCase::IgnoreCase);
+	
+	FString OutFile = FPaths::ChangeExtension(InFile, bJson ? TEXT("json") : TEXT("csv"));
+	FParse::Value(*Params, TEXT("Out="), OutFile);
+	
+	TArray<FCombatEvent> Events;
+	if (!FCombatTelemetry::ReadFile(InFile, Events))
+	{
+		UE_LOG(LogCMP302, Error, TEXT("%s is not a combat telemetry file"), *InFile);
+		return 1;
+	}
+	
+	// Frame records are written at the end of their frame, gather them first so every event can be matched
+	TMap<uint32, const FCombatEvent*> Frames;
+	for (const FCombatEvent& Event : Events)
+	{
+		if (Event.Type == ECombatEventType::Frame)
+		{
+			Frames.Add(Event.FrameNumber, &Event);
+		}
+	}
+	
+	FString Output = bJson
+		? TEXT("[\n")
+		: TEXT("Frame,Time,Type,X,Y,Z,Value,ObjectId,FrameMs,GameThreadMs\n");
+	
+	bool bFirst = true;
+	for (const FCombatEvent& Event : Events)
+	{
+		if (Event.Type == ECombatEventType::Frame)
+		{
+			continue;
+		}
+		
+		const FCombatEvent* const* Frame = Frames.Find(Event.FrameNumber);
+		const float FrameMs = Frame != nullptr ? (*Frame)->Value : 0.f;
+		const float GameThreadMs = Frame != nullptr ? (*Frame)->ObjectId / 1000.f : 0.f;
+		
+		if (bJson)
+		{
+			Output += FString::Printf(TEXT("%s  {\"frame\":%u,\"time\":%.6f,\"type\":\"%s\",\"x\":%.2f,\"y\":%.2f,\"z\":%.2f,\"value\":%g,\"object\":%u,\"frame_ms\":%.3f,\"game_thread_ms\":%.3f}"),
+				bFirst ? TEXT("") : TEXT(",\n"),
+				Event.FrameNumber, Event.Time, LexToString(Event.Type), Event.Location.X, Event.Location.Y, Event.Location.Z, Event.Value, Event.ObjectId, FrameMs, GameThreadMs);
+		}
+		else
+		{
+			Output += FString::Printf(TEXT("%u,%.6f,%s,%.2f,%.2f,%.2f,%g,%u,%.3f,%.3f\n"),
+				Event.FrameNumber, Event.Time, LexToString(Event.Type), Event.Location.X, Event.Location.Y, Event.Location.Z, Event.Value, Event.ObjectId, FrameMs, GameThreadMs);
+		}
+		
+		bFirst = false;
+	}
+	
+	if (bJson)
+	{
+		Output += TEXT("\n]\n");
+	}
+	
+	if (!FFileHelper::SaveStringToFile(Output, *OutFile))
+	{
+		UE_LOG(LogCMP302, Error, TEXT("Couldn't write %s"), *OutFile);
+		return 1;
+	}
+	
+	UE_LOG(LogCMP302, Display, TEXT("Converted %d events over %d frames to %s"), Events.Num() - Frames.Num(), Frames.Num(), *OutFile);
+	return 0;
+}
@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CombatTelemetryCommandlet.generated.h"
+
+/**
+ * Converts a combat telemetry file to CSV or JSON, with every event
+ * lined up against the time of the frame it happened in:
+ *
+ *   UnrealEditor-Cmd CMP302_Coursework -run=CombatTelemetry -In=Telemetry.bin -Out=Telemetry.csv [-Format=json]
+ */
+UCLASS()
+class UCombatTelemetryCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UCombatTelemetryCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
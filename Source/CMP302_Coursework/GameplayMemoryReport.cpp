@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GameplayMemoryReport.h"
+
+#include "CMP302_Coursework.h"
+#include "CMP302_CourseworkProjectile.h"
+#include "TP_WeaponComponent.h"
+#include "Turret.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectIterator.h"
+
+namespace
+{
+	void AddInstance(TMap<FString, CMP302::FMemoryReportRow>& Rows, const FString& Name, const UObject* Object)
+	{
+		CMP302::FMemoryReportRow& Row = Rows.FindOrAdd(Name);
+		Row.Name = Name;
+		Row.Count++;
+		Row.TotalBytes += CMP302::GetInstanceBytes(Object);
+	}
+	
+	template<typename ActorType>
+	void AddActors(TMap<FString, CMP302::FMemoryReportRow>& Rows, UWorld* World)
+	{
+		const FString ActorName = ActorType::StaticClass()->GetPrefixCPP() + ActorType::StaticClass()->GetName();
+		
+		for(TActorIterator<ActorType> It(World); It; ++It) {
+			AddInstance(Rows, ActorName, *It);
+			
+			for(const UActorComponent* Component : It->GetComponents())
+				AddInstance(Rows, ActorName + TEXT("/") + Component->GetClass()->GetName(), Component);
+		}
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs MemReportCommand(
+	TEXT("CMP302.MemReport"),
+	TEXT("Writes live counts and sizes of turrets, projectiles and weapons to a CSV file. Optional argument: file name."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr)
+		{
+			return;
+		}
+
+		const FString Filename = Args.Num() > 0
+			? Args[0]
+			: FPaths::ProfilingDir() / TEXT("CMP302") / FString::Printf(TEXT("MemReport-%s.csv"), *FDateTime::Now().ToString());
+
+		const TArray<CMP302::FMemoryReportRow> Rows = CMP302::GatherMemoryReport(World);
+
+		uint64 TotalBytes = 0;
+		for (const CMP302::FMemoryReportRow& Row : Rows)
+		{
+			TotalBytes += Row.TotalBytes;
+		}
+
+		if (CMP302::WriteMemoryReportCsv(Rows, Filename))
+		{
+			UE_LOG(LogCMP302, Display, TEXT("Gameplay memory report: %d classes, %.1f KB, written to %s"), Rows.Num(), TotalBytes / 1024.0, *Filename);
+		}
+		else
+		{
+			UE_LOG(LogCMP302, Warning, TEXT("Couldn't write gameplay memory report to %s"), *Filename);
+		}
+	}));
+
+uint64 CMP302::GetInstanceBytes(const UObject* Object)
+{
+	FResourceSizeEx ResourceSize(EResourceSizeMode::Exclusive);
+	const_cast<UObject*>(Object)->GetResourceSizeEx(ResourceSize);
+	
+	return Object->GetClass()->GetStructureSize() + ResourceSize.GetTotalMemoryBytes();
+}
+
+TArray<CMP302::FMemoryReportRow> CMP302::GatherMemoryReport(UWorld* World)
+{
+	TMap<FString, FMemoryReportRow> Rows;
+	
+	AddActors<ATurret>(Rows, World);
+	AddActors<ACMP302_CourseworkProjectile>(Rows, World);
+	
+	// Weapons are components on whichever actor picked them up
+	for(TObjectIterator<UTP_WeaponComponent> It; It; ++It) {
+		if(It->GetWorld() == World)
+			AddInstance(Rows, TEXT("UTP_WeaponComponent"), *It);
+	}
+	
+	TArray<FMemoryReportRow> Result;
+	Rows.GenerateValueArray(Result);
+	Result.Sort([](const FMemoryReportRow& A, const FMemoryReportRow& B) { return A.TotalBytes > B.TotalBytes; });
+	
+	return Result;
+}
+
+bool CMP302::WriteMemoryReportCsv(const TArray<FMemoryReportRow>& Rows, const FString& Filename)
+{
+	FString Csv = TEXT("Class,Count,BytesPerInstance,TotalBytes\n");
+	
+	for(const FMemoryReportRow& Row : Rows)
+		Csv += FString::Printf(TEXT("%s,%d,%llu,%llu\n"), *Row.Name, Row.Count, Row.GetBytesPerInstance(), Row.TotalBytes);
+	
+	return FFileHelper::SaveStringToFile(Csv, *Filename);
+}
@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace CMP302
+{
+	/** Live instances of one class in the gameplay memory report */
+	struct FMemoryReportRow
+	{
+		/** Class name, with the owning actor class in front for components */
+		FString Name;
+		int32 Count = 0;
+		uint64 TotalBytes = 0;
+
+		uint64 GetBytesPerInstance() const { return Count > 0 ? TotalBytes / Count : 0; }
+	};
+
+	/** Class size plus the memory the object owns exclusively, as reported by GetResourceSizeEx */
+	CMP302_COURSEWORK_API uint64 GetInstanceBytes(const UObject* Object);
+
+	/**
+	 * Counts the turrets, projectiles and weapons alive in the world along
+	 * with their components. Each instance is its class size plus the
+	 * memory it owns exclusively, as reported by GetResourceSizeEx.
+	 */
+	CMP302_COURSEWORK_API TArray<FMemoryReportRow> GatherMemoryReport(UWorld* World);
+
+	/** Writes the report as CSV, one row per class */
+	CMP302_COURSEWORK_API bool WriteMemoryReportCsv(const TArray<FMemoryReportRow>& Rows, const FString& Filename);
+}
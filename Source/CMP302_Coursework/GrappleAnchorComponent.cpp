@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrappleAnchorComponent.h"
+
+#include "GrappleTargetSubsystem.h"
+
+void UGrappleAnchorComponent::BeginPlay()
+{
+	Super::BeginPlay();
+	
+	if(UGrappleTargetSubsystem* GrappleTargets = GetWorld()->GetSubsystem<UGrappleTargetSubsystem>())
+		GrappleTargets->RegisterAnchor(this);
+}
+
+void UGrappleAnchorComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if(UGrappleTargetSubsystem* GrappleTargets = GetWorld()->GetSubsystem<UGrappleTargetSubsystem>())
+		GrappleTargets->UnregisterAnchor(this);
+	
+	Super::EndPlay(EndPlayReason);
+}
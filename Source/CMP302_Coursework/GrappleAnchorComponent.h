@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "GrappleAnchorComponent.generated.h"
+
+/**
+ * Marks a point the grappling hook can attach to. Anchors are indexed by
+ * UGrappleTargetSubsystem where they are when play begins, so they are
+ * meant for things that don't move.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class CMP302_COURSEWORK_API UGrappleAnchorComponent : public USceneComponent
+{
+	GENERATED_BODY()
+
+public:
+	/** Added to the candidate's score, to favour some anchors over others */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grappling Hook")
+	float ScoreBias = 0;
+
+	/** Index in the subsystem's anchor list, kept up to date by the subsystem */
+	int32 AnchorIndex = INDEX_NONE;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+};
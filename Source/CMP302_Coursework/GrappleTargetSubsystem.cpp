@@ -0,0 +1,243 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GrappleTargetSubsystem.h"
+
+#include "GrappleAnchorComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Kismet/GameplayStatics.h"
+
+void UGrappleTargetSubsystem::Deinitialize()
+{
+	// The task only holds copies, but don't leave it running past the world
+	if(bScoringInFlight)
+		ScoringTask.Wait();
+	
+	Super::Deinitialize();
+}
+
+void UGrappleTargetSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	
+	APlayerController* PlayerController = UGameplayStatics::GetPlayerController(this, 0);
+	if(PlayerController == nullptr || !PlayerController->IsLocalController()) {
+		BestTarget = FGrappleTarget();
+		return;
+	}
+	
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+	const FVector ViewDirection = ViewRotation.Vector();
+	
+	if(bGridDirty)
+		RebuildGrid();
+	
+	// Last frame's traces are done by now, publish what they found
+	const bool bTracesResolved = ResolveTraces();
+	
+	if(bTracesResolved) {
+		// Candidates scored since the last traces went out, or none if the task is still busy
+		TArray<FCandidate> Candidates;
+		if(bScoringInFlight && ScoringTask.IsCompleted()) {
+			Candidates = MoveTemp(ScoringTask.GetResult());
+			bScoringInFlight = false;
+		}
+		
+		TracedCandidates = MoveTemp(Candidates);
+		IssueTraces(ViewLocation, ViewDirection, PlayerController->GetPawn());
+	}
+	
+	if(!bScoringInFlight)
+		LaunchScoring(ViewLocation, ViewDirection);
+}
+
+TStatId UGrappleTargetSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGrappleTargetSubsystem, STATGROUP_Tickables);
+}
+
+void UGrappleTargetSubsystem::RegisterAnchor(UGrappleAnchorComponent* Anchor)
+{
+	if(Anchor->AnchorIndex != INDEX_NONE)
+		return;
+	
+	Anchor->AnchorIndex = Anchors.Add({ Anchor->GetComponentLocation(), Anchor->ScoreBias, Anchor });
+	bGridDirty = true;
+}
+
+void UGrappleTargetSubsystem::UnregisterAnchor(UGrappleAnchorComponent* Anchor)
+{
+	const int32 Index = Anchor->AnchorIndex;
+	if(!Anchors.IsValidIndex(Index))
+		return;
+	
+	Anchors.RemoveAtSwap(Index);
+	Anchor->AnchorIndex = INDEX_NONE;
+	
+	// The last anchor took its place
+	if(Anchors.IsValidIndex(Index) && Anchors[Index].Anchor.IsValid())
+		Anchors[Index].Anchor->AnchorIndex = Index;
+	
+	bGridDirty = true;
+}
+
+void UGrappleTargetSubsystem::RebuildGrid()
+{
+	Grid.Reset();
+	
+	for(int32 Index = 0; Index < Anchors.Num(); Index++)
+		Grid.FindOrAdd(GetCell(Anchors[Index].Location)).Add(Index);
+	
+	bGridDirty = false;
+}
+
+FIntVector UGrappleTargetSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntVector(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize), FMath::FloorToInt32(Location.Z / CellSize));
+}
+
+void UGrappleTargetSubsystem::LaunchScoring(const FVector& ViewLocation, const FVector& ViewDirection)
+{
+	if(Anchors.Num() == 0)
+		return;
+	
+	// Only the cells within reach, the task does the exact checks
+	TArray<FCandidate> Candidates;
+	const FIntVector MinCell = GetCell(ViewLocation - FVector(MaxRange));
+	const FIntVector MaxCell = GetCell(ViewLocation + FVector(MaxRange));
+	
+	for(int32 X = MinCell.X; X <= MaxCell.X; X++) {
+		for(int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++) {
+			for(int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++) {
+				const TArray<int32>* Cell = Grid.Find(FIntVector(X, Y, Z));
+				if(Cell == nullptr)
+					continue;
+				
+				for(const int32 Index : *Cell)
+					Candidates.Add({ Anchors[Index].Location, Anchors[Index].ScoreBias, 0.f, Anchors[Index].Anchor });
+			}
+		}
+	}
+	
+	if(Candidates.Num() == 0)
+		return;
+	
+	const float Range = MaxRange;
+	const float MinCosAngle = FMath::Cos(FMath::DegreesToRadians(ViewConeHalfAngle));
+	const float AngleScale = AngleWeight;
+	const float DistanceScale = DistanceWeight;
+	const int32 MaxResults = MaxOcclusionTraces;
+	
+	ScoringTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Candidates = MoveTemp(Candidates), ViewLocation, ViewDirection, Range, MinCosAngle, AngleScale, DistanceScale, MaxResults]() mutable
+	{
+		TArray<FCandidate> Results;
+		
+		for(FCandidate& Candidate : Candidates) {
+			const FVector ToCandidate = Candidate.Location - ViewLocation;
+			const float Distance = ToCandidate.Size();
+			if(Distance > Range || Distance < UE_KINDA_SMALL_NUMBER)
+				continue;
+			
+			const float CosAngle = (ToCandidate / Distance) | ViewDirection;
+			if(CosAngle < MinCosAngle)
+				continue;
+			
+			// Both terms go from 0 at the edge of the cone or range to 1 dead ahead or right next to us
+			const float AngleScore = (CosAngle - MinCosAngle) / FMath::Max(1.f - MinCosAngle, UE_KINDA_SMALL_NUMBER);
+			const float DistanceScore = 1.f - Distance / Range;
+			
+			Candidate.Score = AngleScale * AngleScore + DistanceScale * DistanceScore + Candidate.ScoreBias;
+			Results.Add(Candidate);
+		}
+		
+		Results.Sort([](const FCandidate& A, const FCandidate& B) { return A.Score > B.Score; });
+		
+		if(Results.Num() > MaxResults)
+			Results.SetNum(MaxResults);
+		
+		return Results;
+	});
+	
+	bScoringInFlight = true;
+}
+
+void UGrappleTargetSubsystem::IssueTraces(const FVector& ViewLocation, const FVector& ViewDirection, const APawn* Pawn)
+{
+	UWorld* const World = GetWorld();
+	
+	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(GrappleTarget), true, Pawn);
+	
+	// Including the weapon the player is holding
+	if(Pawn != nullptr) {
+		TArray<AActor*> AttachedActors;
+		Pawn->GetAttachedActors(AttachedActors);
+		TraceParams.AddIgnoredActors(AttachedActors);
+	}
+	
+	OcclusionTraces.Reset();
+	for(const FCandidate& Candidate : TracedCandidates)
+		OcclusionTraces.Add(World->AsyncLineTraceByChannel(EAsyncTraceType::Single, ViewLocation, Candidate.Location, ECC_Visibility, TraceParams));
+	
+	// Same trace the hook has always made, for when there's no anchor in view
+	SurfaceTrace = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, ViewLocation, ViewLocation + ViewDirection * MaxRange, ECC_Visibility, TraceParams);
+}
+
+bool UGrappleTargetSubsystem::ResolveTraces()
+{
+	if(!SurfaceTrace.IsValid())
+		return true;
+	
+	UWorld* const World = GetWorld();
+	FTraceDatum Datum;
+	
+	// The surface trace was issued last, if it is done the anchor traces are too.
+	// Results only live for a couple of frames, so give up and trace again if they never turn up.
+	if(!World->QueryTraceData(SurfaceTrace, Datum)) {
+		if(++FramesWaitingForTraces < 3)
+			return false;
+		
+		FramesWaitingForTraces = 0;
+		SurfaceTrace = FTraceHandle();
+		OcclusionTraces.Reset();
+		return true;
+	}
+	
+	FramesWaitingForTraces = 0;
+	
+	FGrappleTarget NewTarget;
+	
+	const FHitResult* SurfaceHit = FHitResult::GetFirstBlockingHit(Datum.OutHits);
+	if(SurfaceHit != nullptr) {
+		NewTarget.bValid = true;
+		NewTarget.Location = SurfaceHit->ImpactPoint;
+	}
+	
+	// Candidates are in score order, the first one with nothing in the way wins
+	for(int32 Index = 0; Index < OcclusionTraces.Num(); Index++) {
+		const FCandidate& Candidate = TracedCandidates[Index];
+		if(!Candidate.Anchor.IsValid() || !World->QueryTraceData(OcclusionTraces[Index], Datum))
+			continue;
+		
+		// Hitting whatever the anchor is attached to, right at the anchor, still counts as a clear line
+		const FHitResult* Blocker = FHitResult::GetFirstBlockingHit(Datum.OutHits);
+		const bool bOccluded = Blocker != nullptr
+			&& Blocker->GetActor() != Candidate.Anchor->GetOwner()
+			&& FVector::DistSquared(Blocker->ImpactPoint, Candidate.Location) > FMath::Square(50.f);
+		
+		if(bOccluded)
+			continue;
+		
+		NewTarget.bValid = true;
+		NewTarget.Location = Candidate.Location;
+		NewTarget.Anchor = Candidate.Anchor;
+		break;
+	}
+	
+	BestTarget = NewTarget;
+	SurfaceTrace = FTraceHandle();
+	OcclusionTraces.Reset();
+	
+	return true;
+}
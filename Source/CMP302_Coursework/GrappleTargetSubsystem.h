@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
+#include "WorldCollision.h"
+#include "GrappleTargetSubsystem.generated.h"
+
+class UGrappleAnchorComponent;
+
+/** Where the grappling hook would attach if it was fired now */
+USTRUCT(BlueprintType)
+struct FGrappleTarget
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="Grappling Hook")
+	bool bValid = false;
+
+	UPROPERTY(BlueprintReadOnly, Category="Grappling Hook")
+	FVector Location = FVector::ZeroVector;
+
+	/** Set when the target is an anchor rather than whatever surface is straight ahead */
+	UPROPERTY(BlueprintReadOnly, Category="Grappling Hook")
+	TWeakObjectPtr<UGrappleAnchorComponent> Anchor;
+};
+
+/**
+ * Works out the grappling hook target ahead of time, so firing the hook
+ * never waits on a collision query.
+ *
+ * Every frame, anchors near the local player are looked up in a grid and
+ * scored on a background task by how close they are to the view direction
+ * and how far away they are. The best few are checked for line of sight
+ * with async traces, along with an async trace straight ahead for plain
+ * surfaces, and the winner is published the frame after. An unblocked
+ * anchor beats the surface ahead.
+ */
+UCLASS()
+class CMP302_COURSEWORK_API UGrappleTargetSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual void Deinitialize() override;
+	// End of USubsystem interface
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+	void RegisterAnchor(UGrappleAnchorComponent* Anchor);
+	void UnregisterAnchor(UGrappleAnchorComponent* Anchor);
+
+	/** Best target found for the local player, at most a couple of frames old */
+	UFUNCTION(BlueprintPure, Category="Grappling Hook")
+	const FGrappleTarget& GetBestTarget() const { return BestTarget; }
+
+public:
+	/** Furthest the hook reaches */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grappling Hook")
+	float MaxRange = 3000;
+
+	/** Half angle, in degrees, of the cone in front of the camera anchors have to be in */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grappling Hook")
+	float ViewConeHalfAngle = 20;
+
+	/** How much being near the centre of the view counts for */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grappling Hook")
+	float AngleWeight = 0.7f;
+
+	/** How much being close counts for */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grappling Hook")
+	float DistanceWeight = 0.3f;
+
+	/** Best scoring anchors checked for line of sight each frame */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Grappling Hook")
+	int32 MaxOcclusionTraces = 4;
+
+private:
+	struct FAnchorEntry
+	{
+		FVector Location;
+		float ScoreBias;
+		TWeakObjectPtr<UGrappleAnchorComponent> Anchor;
+	};
+
+	/** Copied to the scoring task, which only reads the location and bias and never touches the anchor */
+	struct FCandidate
+	{
+		FVector Location;
+		float ScoreBias;
+		float Score;
+		TWeakObjectPtr<UGrappleAnchorComponent> Anchor;
+	};
+
+	void RebuildGrid();
+	FIntVector GetCell(const FVector& Location) const;
+
+	/** Starts scoring the anchors around the view on a background task */
+	void LaunchScoring(const FVector& ViewLocation, const FVector& ViewDirection);
+
+	/** Starts the line of sight traces for the scored candidates and the surface ahead */
+	void IssueTraces(const FVector& ViewLocation, const FVector& ViewDirection, const APawn* Pawn);
+
+	/** Picks the best target from last frame's traces, returns false if they aren't ready yet */
+	bool ResolveTraces();
+
+	TArray<FAnchorEntry> Anchors;
+	TMap<FIntVector, TArray<int32>> Grid;
+	bool bGridDirty = false;
+	static constexpr float CellSize = 1000;
+
+	UE::Tasks::TTask<TArray<FCandidate>> ScoringTask;
+	bool bScoringInFlight = false;
+
+	TArray<FCandidate> TracedCandidates;
+	TArray<FTraceHandle> OcclusionTraces;
+	FTraceHandle SurfaceTrace;
+	int32 FramesWaitingForTraces = 0;
+
+	FGrappleTarget BestTarget;
+};
@@ -0,0 +1,222 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PerfGateSubsystem.h"
+
+#include "CMP302_Coursework.h"
+#include "CMP302_CourseworkCharacter.h"
+#include "TP_WeaponComponent.h"
+#include "Turret.h"
+#include "TurretPopulationSubsystem.h"
+#include "RenderCore.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+bool UPerfGateSubsystem::StartPopulating(int32 InNumTurrets)
+{
+	if(bRunning)
+		return false;
+	
+	UWorld* const World = GetWorld();
+	ACMP302_CourseworkCharacter* Pawn = Cast<ACMP302_CourseworkCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+	UTurretPopulationSubsystem* Population = World->GetSubsystem<UTurretPopulationSubsystem>();
+	UClass* Class = TurretClass.LoadSynchronous();
+	
+	if(Pawn == nullptr || Population == nullptr || Class == nullptr) {
+		UE_LOG(LogCMP302, Error, TEXT("PerfGate needs a player character and a valid TurretClass"));
+		return false;
+	}
+	
+	// The scenario is meant to have the grappling hook active the whole time
+	if(!EquipWeapon(Pawn)) {
+		UE_LOG(LogCMP302, Error, TEXT("PerfGate couldn't give the player a weapon, check WeaponClass"));
+		return false;
+	}
+	
+	Center = Pawn->GetActorLocation();
+	
+	// Evenly spaced ring facing inwards, close enough for every turret to shoot
+	TArray<FTurretSpawnRequest> Requests;
+	Requests.Reserve(InNumTurrets);
+	for(int32 Index = 0; Index < InNumTurrets; Index++) {
+		const float Angle = 2.0f * PI * Index / InNumTurrets;
+		const FVector Offset(FMath::Cos(Angle) * TurretRingRadius, FMath::Sin(Angle) * TurretRingRadius, 0);
+		
+		FTurretSpawnRequest& Request = Requests.AddDefaulted_GetRef();
+		Request.TurretClass = Class;
+		Request.Transform = FTransform((-Offset).Rotation(), Center + Offset);
+	}
+	
+	Population->PopulateTurrets(Requests);
+	
+	ActorSpawnedHandle = World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UPerfGateSubsystem::OnActorSpawned));
+	
+	Phase = EPhase::Populating;
+	bRunning = true;
+	bGrappling = false;
+	
+	UE_LOG(LogCMP302, Display, TEXT("PerfGate started with %d turrets"), InNumTurrets);
+	return true;
+}
+
+void UPerfGateSubsystem::StartWarmup()
+{
+	Phase = EPhase::Warmup;
+	PhaseTimeRemaining = WarmupSeconds;
+}
+
+void UPerfGateSubsystem::StartMeasuring()
+{
+	Phase = EPhase::Measuring;
+	PhaseTimeRemaining = MeasureSeconds;
+	
+	GameThreadMsSamples.Reset();
+	PeakSpawnsPerFrame = 0;
+	TotalSpawns = 0;
+	PeakUsedPhysical = 0;
+}
+
+void UPerfGateSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	
+	if(!bRunning)
+		return;
+	
+	UpdateScriptedTarget(DeltaTime);
+	
+	switch(Phase) {
+	case EPhase::Populating:
+		if(!GetWorld()->GetSubsystem<UTurretPopulationSubsystem>()->IsPopulating())
+			Phase = EPhase::Idle;
+		break;
+	
+	case EPhase::Warmup:
+		PhaseTimeRemaining -= DeltaTime;
+		if(PhaseTimeRemaining <= 0)
+			Phase = EPhase::Idle;
+		break;
+	
+	case EPhase::Measuring:
+		// Game thread time of the last completed frame
+		GameThreadMsSamples.Add(FPlatformTime::ToMilliseconds(GGameThreadTime));
+		PeakSpawnsPerFrame = FMath::Max(PeakSpawnsPerFrame, SpawnsThisFrame);
+		TotalSpawns += SpawnsThisFrame;
+		PeakUsedPhysical = FMath::Max<uint64>(PeakUsedPhysical, FPlatformMemory::GetStats().UsedPhysical);
+		
+		PhaseTimeRemaining -= DeltaTime;
+		if(PhaseTimeRemaining <= 0)
+			Phase = EPhase::Idle;
+		break;
+	
+	default:
+		break;
+	}
+	
+	SpawnsThisFrame = 0;
+}
+
+TStatId UPerfGateSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPerfGateSubsystem, STATGROUP_Tickables);
+}
+
+void UPerfGateSubsystem::UpdateScriptedTarget(float DeltaTime)
+{
+	ACMP302_CourseworkCharacter* Character = Cast<ACMP302_CourseworkCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+	if(Character == nullptr)
+		return;
+	
+	// Circle inside the ring so the turrets have to keep turning
+	TargetAngle += DeltaTime;
+	Character->SetActorLocation(Center + FVector(FMath::Cos(TargetAngle), FMath::Sin(TargetAngle), 0) * TargetOrbitRadius);
+	
+	// Hold the grappling hook on a point above the ring
+	if(Character->GetHasRifle() && Character->weapon != nullptr) {
+		Character->weapon->IsGrappling = true;
+		Character->weapon->GrapplingEndPosition = Center + FVector(0, 0, 1000);
+		bGrappling = true;
+	}
+}
+
+bool UPerfGateSubsystem::EquipWeapon(ACMP302_CourseworkCharacter* Character)
+{
+	if(Character->GetHasRifle() && Character->weapon != nullptr)
+		return true;
+	
+	UClass* Class = WeaponClass.LoadSynchronous();
+	if(Class == nullptr)
+		return false;
+	
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	
+	const AActor* Pickup = GetWorld()->SpawnActor<AActor>(Class, Character->GetActorTransform(), SpawnParams);
+	UTP_WeaponComponent* Weapon = Pickup != nullptr ? Pickup->FindComponentByClass<UTP_WeaponComponent>() : nullptr;
+	if(Weapon == nullptr)
+		return false;
+	
+	// Same as walking over the pickup, without relying on the overlap
+	Weapon->AttachWeapon(Character);
+	return Character->weapon != nullptr;
+}
+
+void UPerfGateSubsystem::OnActorSpawned(AActor* Actor)
+{
+	SpawnsThisFrame++;
+}
+
+FPerfGateResult UPerfGateSubsystem::Finish()
+{
+	Phase = EPhase::Idle;
+	bRunning = false;
+	GetWorld()->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	
+	ACMP302_CourseworkCharacter* Character = Cast<ACMP302_CourseworkCharacter>(UGameplayStatics::GetPlayerPawn(this, 0));
+	if(bGrappling && Character != nullptr && Character->weapon != nullptr)
+		Character->weapon->StopGrapplingHook(FInputActionValue());
+	
+	FPerfGateResult Result;
+	Result.NumFrames = GameThreadMsSamples.Num();
+	Result.bGrappling = bGrappling;
+	
+	for(const float Sample : GameThreadMsSamples)
+		Result.AverageGameThreadMs += Sample;
+	Result.AverageGameThreadMs = Result.NumFrames > 0 ? Result.AverageGameThreadMs / Result.NumFrames : 0;
+	
+	GameThreadMsSamples.Sort();
+	Result.P99GameThreadMs = Result.NumFrames > 0 ? GameThreadMsSamples[FMath::Clamp(FMath::CeilToInt32(Result.NumFrames * 0.99f) - 1, 0, Result.NumFrames - 1)] : 0;
+	
+	Result.PeakSpawnsPerFrame = PeakSpawnsPerFrame;
+	Result.AverageSpawnsPerFrame = Result.NumFrames > 0 ? static_cast<double>(TotalSpawns) / Result.NumFrames : 0.0;
+	Result.PeakMemoryMB = PeakUsedPhysical / (1024.0 * 1024.0);
+	
+	const UTurretPopulationSubsystem* Population = GetWorld()->GetSubsystem<UTurretPopulationSubsystem>();
+	Result.NumTurrets = Population != nullptr ? Population->GetNumSpawned() : 0;
+	
+	Result.bAveragePassed = Result.AverageGameThreadMs <= MaxAverageGameThreadMs;
+	Result.bP99Passed = Result.P99GameThreadMs <= MaxP99GameThreadMs;
+	Result.bSpawnsPassed = Result.PeakSpawnsPerFrame <= MaxSpawnsPerFrame;
+	Result.bMemoryPassed = Result.PeakMemoryMB <= MaxPeakMemoryMB;
+	
+	const FString Json = FString::Printf(
+		TEXT("{\"passed\":%s,\"turrets\":%d,\"grapple\":%s,\"frames\":%d,")
+		TEXT("\"avg_game_thread_ms\":%.3f,\"avg_game_thread_budget_ms\":%.3f,")
+		TEXT("\"p99_game_thread_ms\":%.3f,\"p99_game_thread_budget_ms\":%.3f,")
+		TEXT("\"peak_spawns_per_frame\":%d,\"spawns_per_frame_budget\":%d,\"avg_spawns_per_frame\":%.2f,")
+		TEXT("\"peak_memory_mb\":%.1f,\"peak_memory_budget_mb\":%.1f}"),
+		Result.Passed() ? TEXT("true") : TEXT("false"),
+		Result.NumTurrets,
+		Result.bGrappling ? TEXT("true") : TEXT("false"),
+		Result.NumFrames,
+		Result.AverageGameThreadMs, MaxAverageGameThreadMs,
+		Result.P99GameThreadMs, MaxP99GameThreadMs,
+		Result.PeakSpawnsPerFrame, MaxSpawnsPerFrame, Result.AverageSpawnsPerFrame,
+		Result.PeakMemoryMB, MaxPeakMemoryMB);
+	
+	UE_LOG(LogCMP302, Display, TEXT("PerfGate %s"), *Json);
+	FFileHelper::SaveStringToFile(Json, *(FPaths::ProfilingDir() / TEXT("CMP302") / TEXT("PerfGate.json")));
+	
+	return Result;
+}
@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PerfGateSubsystem.generated.h"
+
+class ATurret;
+class ACMP302_CourseworkCharacter;
+
+/** What the performance scenario measured, and the budgets it was checked against */
+struct FPerfGateResult
+{
+	int32 NumTurrets = 0;
+	int32 NumFrames = 0;
+	bool bGrappling = false;
+
+	float AverageGameThreadMs = 0;
+	float P99GameThreadMs = 0;
+	int32 PeakSpawnsPerFrame = 0;
+	double AverageSpawnsPerFrame = 0;
+	double PeakMemoryMB = 0;
+
+	bool bAveragePassed = false;
+	bool bP99Passed = false;
+	bool bSpawnsPassed = false;
+	bool bMemoryPassed = false;
+
+	bool Passed() const { return NumFrames > 0 && bAveragePassed && bP99Passed && bSpawnsPassed && bMemoryPassed; }
+};
+
+/**
+ * Runs the turret performance scenario for the CMP302.Perf.TurretBudget
+ * automation test. Spawns a ring of turrets around the player, moves the
+ * player around inside the ring with the grappling hook active so every
+ * turret keeps firing, then measures game thread time, actor spawns per
+ * frame and peak memory against the budgets in the
+ * [/Script/CMP302_Coursework.PerfGateSubsystem] section of DefaultGame.ini.
+ *
+ * The test opens ReferenceMap, drives the phases with one latent command
+ * each, and fails for every budget that was exceeded. The player is given
+ * WeaponClass if they aren't holding a weapon, so the grapple is always on. Meant to be run headless:
+ *
+ *   UnrealEditor-Cmd CMP302_Coursework -game -nullrhi -nosound -unattended -ExecCmds="Automation RunTests CMP302.Perf; Quit"
+ *
+ * Results are also logged as a single JSON line and written to
+ * Saved/Profiling/CMP302/PerfGate.json.
+ */
+UCLASS(config=Game)
+class CMP302_COURSEWORK_API UPerfGateSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Spawns the turret ring, returns false if the scenario can't be built */
+	bool StartPopulating(int32 InNumTurrets);
+
+	/** Lets the scenario run for WarmupSeconds without measuring */
+	void StartWarmup();
+
+	/** Samples every frame for MeasureSeconds */
+	void StartMeasuring();
+
+	/** True until the current phase has finished */
+	bool IsBusy() const { return Phase != EPhase::Idle; }
+
+	/** True from StartPopulating until Finish */
+	bool IsRunning() const { return bRunning; }
+
+	/** Ends the scenario, then logs and saves the results */
+	FPerfGateResult Finish();
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+public:
+	/** Map the scenario is run in, opened by the test before it starts */
+	UPROPERTY(Config)
+	FString ReferenceMap;
+
+	UPROPERTY(Config)
+	TSoftClassPtr<ATurret> TurretClass;
+
+	/** Weapon pickup given to the player if they aren't holding one, the grappling hook needs it */
+	UPROPERTY(Config)
+	TSoftClassPtr<AActor> WeaponClass;
+
+	UPROPERTY(Config)
+	int32 NumTurrets = 200;
+
+	/** Distance of the turret ring from the player, inside the turrets' shoot distance */
+	UPROPERTY(Config)
+	float TurretRingRadius = 700;
+
+	/** Radius of the circle the player is moved around */
+	UPROPERTY(Config)
+	float TargetOrbitRadius = 300;
+
+	UPROPERTY(Config)
+	float WarmupSeconds = 3;
+
+	UPROPERTY(Config)
+	float MeasureSeconds = 20;
+
+	UPROPERTY(Config)
+	float MaxAverageGameThreadMs = 8;
+
+	UPROPERTY(Config)
+	float MaxP99GameThreadMs = 16;
+
+	UPROPERTY(Config)
+	int32 MaxSpawnsPerFrame = 64;
+
+	UPROPERTY(Config)
+	float MaxPeakMemoryMB = 4096;
+
+private:
+	enum class EPhase : uint8
+	{
+		Idle,
+		Populating,
+		Warmup,
+		Measuring
+	};
+
+	void UpdateScriptedTarget(float DeltaTime);
+
+	/** Makes sure the player holds a weapon, returns false if one couldn't be attached */
+	bool EquipWeapon(ACMP302_CourseworkCharacter* Character);
+	void OnActorSpawned(AActor* Actor);
+
+	EPhase Phase = EPhase::Idle;
+	bool bRunning = false;
+	float PhaseTimeRemaining = 0;
+	FVector Center = FVector::ZeroVector;
+	float TargetAngle = 0;
+	bool bGrappling = false;
+
+	FDelegateHandle ActorSpawnedHandle;
+	int32 SpawnsThisFrame = 0;
+
+	TArray<float> GameThreadMsSamples;
+	int32 PeakSpawnsPerFrame = 0;
+	uint64 TotalSpawns = 0;
+	uint64 PeakUsedPhysical = 0;
+};
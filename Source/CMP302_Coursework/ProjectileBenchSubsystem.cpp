@@ -0,0 +1,136 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ProjectileBenchSubsystem.h"
+
+#include "CMP302_Coursework.h"
+#include "CMP302_CourseworkProjectile.h"
+#include "ProjectileSweepBudgetSubsystem.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+
+static FAutoConsoleCommandWithWorldAndArgs ProjectileBenchCommand(
+	TEXT("CMP302.ProjectileBench"),
+	TEXT("Compares collision queries per frame of stock and adaptive projectile movement. Optional arguments: count (default 1000), seconds per pass (default 2)."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr)
+		{
+			return;
+		}
+
+		if (UProjectileBenchSubsystem* Bench = World->GetSubsystem<UProjectileBenchSubsystem>())
+		{
+			Bench->StartBench(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000, Args.Num() > 1 ? FCString::Atof(*Args[1]) : 2.0f);
+		}
+	}));
+
+void UProjectileBenchSubsystem::StartBench(int32 InNumProjectiles, float InSeconds)
+{
+	if(bRunning)
+		return;
+	
+	bRunning = true;
+	UAdaptiveProjectileMovementComponent::bCollectQueryStats = true;
+	NumProjectiles = InNumProjectiles;
+	PassSeconds = InSeconds;
+	
+	const APawn* Pawn = UGameplayStatics::GetPlayerPawn(this, 0);
+	Origin = Pawn != nullptr ? Pawn->GetActorLocation() + FVector(0, 0, 200) : FVector::ZeroVector;
+	
+	StartPass(false);
+}
+
+void UProjectileBenchSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	
+	if(!bRunning)
+		return;
+	
+	PassFrames++;
+	PassTimeRemaining -= DeltaTime;
+	if(PassTimeRemaining > 0)
+		return;
+	
+	FinishPass();
+	
+	if(!bAdaptivePass) {
+		StartPass(true);
+		return;
+	}
+	
+	bRunning = false;
+	UAdaptiveProjectileMovementComponent::bCollectQueryStats = false;
+	Report();
+}
+
+void UProjectileBenchSubsystem::Deinitialize()
+{
+	if(bRunning)
+		UAdaptiveProjectileMovementComponent::bCollectQueryStats = false;
+	
+	Super::Deinitialize();
+}
+
+TStatId UProjectileBenchSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UProjectileBenchSubsystem, STATGROUP_Tickables);
+}
+
+void UProjectileBenchSubsystem::StartPass(bool bAdaptive)
+{
+	bAdaptivePass = bAdaptive;
+	PassTimeRemaining = PassSeconds;
+	PassFrames = 0;
+	UAdaptiveProjectileMovementComponent::QueryStats = FProjectileQueryStats();
+	
+	// Same seed for both passes, so both fire the same shots
+	FRandomStream Random(302);
+	
+	for(int32 Index = 0; Index < NumProjectiles; Index++) {
+		const FVector Direction = Random.GetUnitVector();
+		const FTransform Transform(Direction.Rotation(), Origin + Direction * Random.FRandRange(100.f, 400.f));
+		
+		ACMP302_CourseworkProjectile* Projectile = GetWorld()->SpawnActorDeferred<ACMP302_CourseworkProjectile>(ACMP302_CourseworkProjectile::StaticClass(), Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+		if(Projectile == nullptr)
+			continue;
+		
+		if(UAdaptiveProjectileMovementComponent* Movement = Cast<UAdaptiveProjectileMovementComponent>(Projectile->GetProjectileMovement()))
+			Movement->bUseAdaptiveCollision = bAdaptive;
+		
+		Projectile->FinishSpawning(Transform);
+		Projectile->SetLifeSpan(PassSeconds + 1.0f);
+		Projectiles.Add(Projectile);
+	}
+}
+
+void UProjectileBenchSubsystem::FinishPass()
+{
+	FProjectileQueryStats& Stats = bAdaptivePass ? AdaptiveStats : StockStats;
+	Stats = UAdaptiveProjectileMovementComponent::QueryStats;
+	(bAdaptivePass ? AdaptiveFrames : StockFrames) = PassFrames;
+	
+	for(const TWeakObjectPtr<ACMP302_CourseworkProjectile>& Projectile : Projectiles) {
+		if(Projectile.IsValid())
+			Projectile->Destroy();
+	}
+	
+	Projectiles.Reset();
+}
+
+void UProjectileBenchSubsystem::Report() const
+{
+	auto PerFrame = [](double Value, int32 Frames) { return Frames > 0 ? Value / Frames : 0.0; };
+	
+	const UProjectileSweepBudgetSubsystem* SweepBudget = GetWorld()->GetSubsystem<UProjectileSweepBudgetSubsystem>();
+	
+	UE_LOG(LogCMP302, Display, TEXT("ProjectileBench {\"projectiles\":%d,\"seconds\":%.2f,\"max_sweeps_per_frame\":%d,")
+		TEXT("\"stock_sweeps_per_frame\":%.1f,\"stock_ms_per_frame\":%.3f,")
+		TEXT("\"adaptive_queries_per_frame\":%.1f,\"adaptive_sweeps_per_frame\":%.1f,\"adaptive_rays_per_frame\":%.1f,")
+		TEXT("\"adaptive_skipped_per_frame\":%.1f,\"adaptive_deferred_per_frame\":%.1f,\"adaptive_ms_per_frame\":%.3f}"),
+		NumProjectiles, PassSeconds, SweepBudget != nullptr ? SweepBudget->MaxSweepsPerFrame : 0,
+		PerFrame(StockStats.NumStockSweeps, StockFrames), PerFrame(FPlatformTime::ToMilliseconds64(StockStats.TickCycles), StockFrames),
+		PerFrame(AdaptiveStats.GetNumQueries(), AdaptiveFrames), PerFrame(AdaptiveStats.NumSweeps, AdaptiveFrames), PerFrame(AdaptiveStats.NumRays, AdaptiveFrames),
+		PerFrame(AdaptiveStats.NumSkipped, AdaptiveFrames), PerFrame(AdaptiveStats.NumDeferred, AdaptiveFrames), PerFrame(FPlatformTime::ToMilliseconds64(AdaptiveStats.TickCycles), AdaptiveFrames));
+}
@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AdaptiveProjectileMovementComponent.h"
+#include "ProjectileBenchSubsystem.generated.h"
+
+class ACMP302_CourseworkProjectile;
+
+/**
+ * Compares collision queries per frame between the stock projectile
+ * movement and UAdaptiveProjectileMovementComponent, started with
+ * "CMP302.ProjectileBench [Count] [Seconds]". The same set of
+ * projectiles is fired once with each, and the result is logged as
+ * a single JSON line. Both passes count every sweep and trace they
+ * make, including the adaptive look ahead and the stock slides.
+ */
+UCLASS()
+class CMP302_COURSEWORK_API UProjectileBenchSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	void StartBench(int32 InNumProjectiles, float InSeconds);
+
+	// USubsystem interface
+	virtual void Deinitialize() override;
+	// End of USubsystem interface
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+private:
+	/** Fires the projectiles for the current pass */
+	void StartPass(bool bAdaptive);
+	void FinishPass();
+	void Report() const;
+
+	bool bRunning = false;
+	bool bAdaptivePass = false;
+	int32 NumProjectiles = 0;
+	float PassSeconds = 0;
+	float PassTimeRemaining = 0;
+	int32 PassFrames = 0;
+	FVector Origin = FVector::ZeroVector;
+
+	TArray<TWeakObjectPtr<ACMP302_CourseworkProjectile>> Projectiles;
+
+	FProjectileQueryStats StockStats;
+	int32 StockFrames = 0;
+	FProjectileQueryStats AdaptiveStats;
+	int32 AdaptiveFrames = 0;
+};
@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ProjectileSweepBudgetSubsystem.h"
+
+bool UProjectileSweepBudgetSubsystem::ConsumeSweep(bool bStarved)
+{
+	if(MaxSweepsPerFrame <= 0)
+		return true;
+	
+	UpdateFrame();
+	
+	// Whoever ticks first would otherwise take the budget every frame, and the same projectiles would always wait
+	const int32 Limit = bStarved ? MaxSweepsPerFrame : MaxSweepsPerFrame - FMath::Min(NumStarved, MaxSweepsPerFrame);
+	if(NumSweeps >= Limit)
+		return false;
+	
+	NumSweeps++;
+	return true;
+}
+
+void UProjectileSweepBudgetSubsystem::MarkStarved()
+{
+	UpdateFrame();
+	NumStarvedThisFrame++;
+}
+
+void UProjectileSweepBudgetSubsystem::UpdateFrame()
+{
+	if(Frame == GFrameCounter)
+		return;
+	
+	Frame = GFrameCounter;
+	NumSweeps = 0;
+	NumStarved = NumStarvedThisFrame;
+	NumStarvedThisFrame = 0;
+}
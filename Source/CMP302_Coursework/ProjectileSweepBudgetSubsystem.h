@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ProjectileSweepBudgetSubsystem.generated.h"
+
+/**
+ * Collision queries every UAdaptiveProjectileMovementComponent in a world
+ * may make each frame, shared between them. Projectiles that ran out of
+ * queries last frame have some kept back for them, so the same ones
+ * aren't left waiting every frame just because they tick last.
+ *
+ * The limit is MaxSweepsPerFrame in the
+ * [/Script/CMP302_Coursework.ProjectileSweepBudgetSubsystem] section of
+ * DefaultGame.ini.
+ */
+UCLASS(config=Game)
+class CMP302_COURSEWORK_API UProjectileSweepBudgetSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Takes one query from this frame's budget, bStarved draws on what was kept back */
+	bool ConsumeSweep(bool bStarved);
+
+	/** Records that a projectile ran out this frame, so a query is kept back for it next frame */
+	void MarkStarved();
+
+public:
+	/** Queries per frame for the whole world, 0 for no limit */
+	UPROPERTY(Config, EditAnywhere, Category="Adaptive Collision", meta=(ClampMin="0"))
+	int32 MaxSweepsPerFrame = 2000;
+
+private:
+	/** Starts a new frame's budget if the frame has moved on */
+	void UpdateFrame();
+
+	uint64 Frame = 0;
+	int32 NumSweeps = 0;
+	/** Projectiles that ran out last frame, this many queries are kept back for them */
+	int32 NumStarved = 0;
+	int32 NumStarvedThisFrame = 0;
+};
@@ -2,18 +2,25 @@
 
 
 #include "TP_WeaponComponent.h"
+#include "CMP302_Coursework.h"
 #include "CMP302_CourseworkCharacter.h"
 #include "CMP302_CourseworkProjectile.h"
+#include "CombatTelemetry.h"
+#include "GrappleTargetSubsystem.h"
 #include "GameFramework/PlayerController.h"
 #include "Camera/PlayerCameraManager.h"
 #include "Kismet/GameplayStatics.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "Components/SphereComponent.h"
 
 // Sets default values for this component's properties
 UTP_WeaponComponent::UTP_WeaponComponent()
 {
+	LLM_SCOPE_BYTAG(CMP302_Weapons);
+
 	// Default offset from the character location for projectiles to spawn
 	MuzzleOffset = FVector(100.0f, 0.0f, 10.0f);
 }
@@ -26,6 +33,116 @@ void UTP_WeaponComponent::Fire()
 		return;
 	}
 
+	SpawnProjectile(0.f);
+	PlayFireEffects();
+}
+
+void UTP_WeaponComponent::StartFiring(const FInputActionValue& Value)
+{
+	FireSchedule.StartFiring(InputBufferTime);
+}
+
+void UTP_WeaponComponent::StopFiring(const FInputActionValue& Value)
+{
+	FireSchedule.StopFiring();
+}
+
+void FWeaponFireSchedule::StartFiring(float InputBufferTime)
+{
+	bTriggerHeld = true;
+
+	// Remember the press for a short while, so a shot asked for during the cooldown isn't lost
+	BufferedInputTime = InputBufferTime;
+}
+
+void FWeaponFireSchedule::StopFiring()
+{
+	bTriggerHeld = false;
+}
+
+bool FWeaponFireSchedule::WantsToFire(EWeaponFireMode FireMode) const
+{
+	switch (FireMode)
+	{
+	case EWeaponFireMode::FullAuto:
+		return bTriggerHeld || BufferedInputTime > 0.f;
+	case EWeaponFireMode::Burst:
+		return BurstShotsRemaining > 0 || BufferedInputTime > 0.f;
+	default:
+		return BufferedInputTime > 0.f;
+	}
+}
+
+int32 FWeaponFireSchedule::Update(float DeltaSeconds, EWeaponFireMode FireMode, float RoundsPerMinute, int32 BurstCount, bool bCanFire, TFunctionRef<void(float TimeSinceShot)> OnShot)
+{
+	/**
+	 * NextShotTime is how long until the weapon can fire again.
+	 * When it drops below zero during a frame, the shot was due
+	 * that long before the end of the frame, so one long frame
+	 * can fire several shots, each placed where it would have
+	 * been had it fired on time. This keeps the number of
+	 * projectiles tied to RoundsPerMinute rather than frame rate.
+	 */
+	NextShotTime -= DeltaSeconds;
+
+	const bool bWantsToFire = WantsToFire(FireMode);
+
+	// Time spent not firing can't be banked for a burst of catch up shots later
+	if (!bWantsToFire || !bWantedToFire)
+	{
+		NextShotTime = FMath::Max(NextShotTime, 0.f);
+	}
+
+	bWantedToFire = bWantsToFire;
+
+	const float ShotInterval = 60.f / FMath::Max(RoundsPerMinute, 1.f);
+	int32 NumShots = 0;
+
+	if (bCanFire)
+	{
+		while (NextShotTime <= 0.f && WantsToFire(FireMode))
+		{
+			if (FireMode == EWeaponFireMode::Burst && BurstShotsRemaining == 0)
+			{
+				BurstShotsRemaining = BurstCount;
+				BufferedInputTime = 0.f;
+			}
+
+			if (FireMode == EWeaponFireMode::Burst)
+			{
+				BurstShotsRemaining--;
+			}
+			else
+			{
+				BufferedInputTime = 0.f;
+			}
+
+			OnShot(-NextShotTime);
+			NextShotTime += ShotInterval;
+			NumShots++;
+		}
+	}
+
+	BufferedInputTime = FMath::Max(BufferedInputTime - DeltaSeconds, 0.f);
+
+	return NumShots;
+}
+
+void UTP_WeaponComponent::UpdateFiring(float DeltaSeconds)
+{
+	const bool bCanFire = Character != nullptr && Character->GetController() != nullptr;
+	const int32 NumShots = FireSchedule.Update(DeltaSeconds, FireMode, RoundsPerMinute, BurstCount, bCanFire,
+		[this](float TimeSinceShot) { SpawnProjectile(TimeSinceShot); });
+
+	// One sound and animation per frame is enough, however many shots it fired
+	if (NumShots > 0)
+	{
+		PlayFireEffects();
+	}
+}
+
+void UTP_WeaponComponent::SpawnProjectile(float TimeSinceShot)
+{
 	// Try and fire a projectile
 	if (ProjectileClass != nullptr)
 	{
@@ -35,17 +152,58 @@ void UTP_WeaponComponent::Fire()
 			APlayerController* PlayerController = Cast<APlayerController>(Character->GetController());
 			const FRotator SpawnRotation = PlayerController->PlayerCameraManager->GetCameraRotation();
 			// MuzzleOffset is in camera space, so transform it to world space before offsetting from the character location to find the final muzzle position
-			const FVector SpawnLocation = GetOwner()->GetActorLocation() + SpawnRotation.RotateVector(MuzzleOffset);
+			FVector SpawnLocation = GetOwner()->GetActorLocation() + SpawnRotation.RotateVector(MuzzleOffset);
+
+			// A shot that was due earlier in the frame has already travelled for that long.
+			// If it would have hit something on the way, it leaves from the muzzle instead
+			// so its own movement delivers the hit.
+			if (TimeSinceShot > 0.f)
+			{
+				const ACMP302_CourseworkProjectile* DefaultProjectile = ProjectileClass->GetDefaultObject<ACMP302_CourseworkProjectile>();
+				const USphereComponent* DefaultCollision = DefaultProjectile->GetCollisionComp();
+				const FVector TravelledLocation = SpawnLocation + SpawnRotation.Vector() * DefaultProjectile->GetProjectileMovement()->InitialSpeed * TimeSinceShot;
+
+				FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(WeaponCatchUpShot), false, GetOwner());
+				QueryParams.AddIgnoredActor(Character);
+
+				FHitResult Hit;
+				const bool bBlocked = World->SweepSingleByChannel(Hit, SpawnLocation, TravelledLocation, FQuat::Identity,
+					DefaultCollision->GetCollisionObjectType(),
+					FCollisionShape::MakeSphere(DefaultCollision->GetScaledSphereRadius()),
+					QueryParams, FCollisionResponseParams(DefaultCollision->GetCollisionResponseToChannels()));
+
+				if (!bBlocked)
+				{
+					SpawnLocation = TravelledLocation;
+				}
+			}
 	
 			//Set Spawn Collision Handling Override
 			FActorSpawnParameters ActorSpawnParams;
 			ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
 	
 			// Spawn the projectile at the muzzle
-			World->SpawnActor<ACMP302_CourseworkProjectile>(ProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
+			LLM_SCOPE_BYTAG(CMP302_Projectiles);
+			const ACMP302_CourseworkProjectile* Projectile = World->SpawnActor<ACMP302_CourseworkProjectile>(ProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
+
+			// The spawn is dropped if there was no room at the muzzle, which isn't a shot
+			if (Projectile != nullptr)
+			{
+				FCombatTelemetry::Record(ECombatEventType::PlayerShot, SpawnLocation, GetUniqueID());
+			}
 		}
 	}
-	
+}
+
+void UTP_WeaponComponent::PlayFireEffects()
+{
+#if !UE_SERVER
+	// Nobody is there to hear or see it
+	if (!CMP302::ShouldPlayCosmetics(this))
+	{
+		return;
+	}
+
 	// Try and play the sound if specified
 	if (FireSound != nullptr)
 	{
@@ -62,10 +220,13 @@ void UTP_WeaponComponent::Fire()
 			AnimInstance->Montage_Play(FireAnimation, 1.f);
 		}
 	}
+#endif
 }
 
 void UTP_WeaponComponent::AttachWeapon(ACMP302_CourseworkCharacter* TargetCharacter)
 {
+	LLM_SCOPE_BYTAG(CMP302_Weapons);
+
 	Character = TargetCharacter;
 	if (Character == nullptr)
 	{
@@ -91,8 +252,10 @@ void UTP_WeaponComponent::AttachWeapon(ACMP302_CourseworkCharacter* TargetCharac
 
 		if (UEnhancedInputComponent* EnhancedInputComponent = Cast<UEnhancedInputComponent>(PlayerController->InputComponent))
 		{
-			// Fire
-			EnhancedInputComponent->BindAction(FireAction, ETriggerEvent::Triggered, this, &UTP_WeaponComponent::Fire);
+			// Fire, the weapon decides when shots happen from its fire rate rather than every frame the input is held
+			EnhancedInputComponent->BindAction(FireAction, ETriggerEvent::Started, this, &UTP_WeaponComponent::StartFiring);
+			EnhancedInputComponent->BindAction(FireAction, ETriggerEvent::Completed, this, &UTP_WeaponComponent::StopFiring);
+			EnhancedInputComponent->BindAction(FireAction, ETriggerEvent::Canceled, this, &UTP_WeaponComponent::StopFiring);
 			
 			EnhancedInputComponent->BindAction(GrapplingHookFireAction, ETriggerEvent::Started, this, &UTP_WeaponComponent::FireGrapplingHook);
 			EnhancedInputComponent->BindAction(GrapplingHookFireAction, ETriggerEvent::Completed, this, &UTP_WeaponComponent::StopGrapplingHook);
@@ -107,33 +270,25 @@ void UTP_WeaponComponent::FireGrapplingHook(const FInputActionValue& Value)
 	
 	Timer = 0;
 	
-	if (APlayerController* PlayerController = Cast<APlayerController>(Character->GetController()))
+	// The target is worked out ahead of time, so the grapple starts without waiting on a trace
+	const UGrappleTargetSubsystem* GrappleTargets = GetWorld()->GetSubsystem<UGrappleTargetSubsystem>();
+	if (GrappleTargets == nullptr || Character == nullptr)
 	{
-		// Get the camera location and forward vector to start the trace
-		FVector CameraLocation;
-		FRotator CameraRotation;
-		PlayerController->GetPlayerViewPoint(CameraLocation, CameraRotation);
-		
-		// Calculate the end of the trace by extending the forward vector
-		FVector TraceEnd = CameraLocation + (CameraRotation.Vector() * 3000); // Set MaxTraceDistance as desired
-		
-		FHitResult HitResult;
-		
-		// Set collision parameters
-		FCollisionQueryParams TraceParams(FName(TEXT("Trace")), true, GetOwner());
+		return;
+	}
+	
+	const FGrappleTarget& Target = GrappleTargets->GetBestTarget();
+	
+	// Check if there is something to attach to
+	if (Target.bValid)
+	{
+		GrapplingEndPosition = Target.Location;
+		IsGrappling = true;
 		
-		// Perform the line trace
-		bool bHit = GetWorld()->LineTraceSingleByChannel(HitResult, CameraLocation, TraceEnd, ECC_Visibility, TraceParams);
+		FCombatTelemetry::Record(ECombatEventType::GrappleStart, GrapplingEndPosition, GetUniqueID());
 		
-		// Check if the trace hit something
-		if (bHit)
-		{
-			GrapplingEndPosition = HitResult.ImpactPoint;
-			IsGrappling = true;
-			
-			// Set the movement mode to flying
-			Character->GetCharacterMovement()->SetMovementMode(MOVE_Flying);
-		}
+		// Set the movement mode to flying
+		Character->GetCharacterMovement()->SetMovementMode(MOVE_Flying);
 	}
 }
 
@@ -144,6 +299,10 @@ void UTP_WeaponComponent::StopGrapplingHook(const FInputActionValue& Value = 0)
 
 	UE_LOG(LogTemp, Warning, TEXT("HI"));
 	
+	// Releasing the button without a grapple attached isn't a grapple ending
+	if(IsGrappling)
+		FCombatTelemetry::Record(ECombatEventType::GrappleStop, Character->GetActorLocation(), GetUniqueID());
+	
 	IsGrappling = false;
 	
 	// Set the movement mode to falling
@@ -153,6 +312,8 @@ void UTP_WeaponComponent::StopGrapplingHook(const FInputActionValue& Value = 0)
 void UTP_WeaponComponent::Update(float DeltaSeconds) {
 	Timer += DeltaSeconds;	
 	
+	UpdateFiring(DeltaSeconds);
+	
 	if(!IsGrappling)
 		return;
 
@@ -9,6 +9,45 @@
 
 class ACMP302_CourseworkCharacter;
 
+UENUM(BlueprintType)
+enum class EWeaponFireMode : uint8
+{
+	/** One shot per press */
+	SemiAuto,
+	/** BurstCount shots per press */
+	Burst,
+	/** Fires for as long as the trigger is held */
+	FullAuto
+};
+
+/**
+ * Works out when each shot is due for a fire mode and rate, kept apart
+ * from the weapon so the timing can be run without a world.
+ */
+struct CMP302_COURSEWORK_API FWeaponFireSchedule
+{
+	/** Holds the trigger and remembers the press for InputBufferTime */
+	void StartFiring(float InputBufferTime);
+
+	void StopFiring();
+
+	bool WantsToFire(EWeaponFireMode FireMode) const;
+
+	/**
+	 * Advances the schedule by DeltaSeconds and calls OnShot for every shot that
+	 * became due, passing how long ago it was due. Nothing fires while bCanFire
+	 * is false. Returns the number of shots fired.
+	 */
+	int32 Update(float DeltaSeconds, EWeaponFireMode FireMode, float RoundsPerMinute, int32 BurstCount, bool bCanFire, TFunctionRef<void(float TimeSinceShot)> OnShot);
+
+private:
+	bool bTriggerHeld = false;
+	bool bWantedToFire = false;
+	float BufferedInputTime = 0.f;
+	float NextShotTime = 0.f;
+	int32 BurstShotsRemaining = 0;
+};
+
 UCLASS(Blueprintable, BlueprintType, ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class CMP302_COURSEWORK_API UTP_WeaponComponent : public USkeletalMeshComponent
 {
@@ -31,6 +70,20 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay)
 	FVector MuzzleOffset;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Firing")
+	EWeaponFireMode FireMode = EWeaponFireMode::FullAuto;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Firing", meta = (ClampMin = "1"))
+	float RoundsPerMinute = 600;
+
+	/** Shots fired by each press in Burst mode */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Firing", meta = (ClampMin = "1"))
+	int32 BurstCount = 3;
+
+	/** How long a press made during the cooldown is remembered for */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Firing", meta = (ClampMin = "0"))
+	float InputBufferTime = 0.15f;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Grappling Hook", meta = (AllowPrivateAccess = "true"))
 	bool IsGrappling = false;
 
@@ -63,9 +116,17 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Weapon")
 	void AttachWeapon(ACMP302_CourseworkCharacter* TargetCharacter);
 
-	/** Make the weapon Fire a Projectile */
+	/** Make the weapon Fire a Projectile straight away, ignoring the fire rate */
 	UFUNCTION(BlueprintCallable, Category="Weapon")
 	void Fire();
+
+	/** Called when the fire input is pressed */
+	UFUNCTION(BlueprintCallable, Category="Weapon")
+	void StartFiring(const FInputActionValue& Value);
+
+	/** Called when the fire input is released */
+	UFUNCTION(BlueprintCallable, Category="Weapon")
+	void StopFiring(const FInputActionValue& Value);
 	
 	/** Called for fire input */
 	UFUNCTION(BlueprintCallable, Category="Weapon")
@@ -84,6 +145,17 @@ protected:
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 private:
+	/** Fires every shot that became due during the frame */
+	void UpdateFiring(float DeltaSeconds);
+
+	/** Spawns a projectile as if it had been fired TimeSinceShot seconds ago */
+	void SpawnProjectile(float TimeSinceShot);
+
+	/** Plays the fire sound and animation */
+	void PlayFireEffects();
+
 	/** The Character holding this weapon*/
 	ACMP302_CourseworkCharacter* Character;
+
+	FWeaponFireSchedule FireSchedule;
 };
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "Tests/AutomationCommon.h"
+#include "CombatTelemetry.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** ObjectId of the event the test looks for, nothing in the game uses it */
+	constexpr uint32 MarkerObjectId = 0xC302C302;
+}
+
+/** Stops recording and checks the marker lines up with the Frame record of the frame it was recorded in */
+DEFINE_LATENT_AUTOMATION_COMMAND_THREE_PARAMETER(FCheckTelemetryFramesCommand, FAutomationTestBase*, Test, FString, Filename, uint32, MarkerFrame);
+
+bool FCheckTelemetryFramesCommand::Update()
+{
+	FCombatTelemetry::StopRecording();
+	
+	TArray<FCombatEvent> Events;
+	if(!FCombatTelemetry::ReadFile(Filename, Events)) {
+		Test->AddError(FString::Printf(TEXT("Couldn't read %s back"), *Filename));
+		return true;
+	}
+	
+	IFileManager::Get().Delete(*Filename);
+	
+	const int32 MarkerIndex = Events.IndexOfByPredicate([](const FCombatEvent& Event)
+	{
+		return Event.Type == ECombatEventType::PlayerShot && Event.ObjectId == MarkerObjectId;
+	});
+	
+	if(MarkerIndex == INDEX_NONE) {
+		Test->AddError(TEXT("The marker event wasn't written"));
+		return true;
+	}
+	
+	Test->TestEqual(TEXT("Marker frame number"), Events[MarkerIndex].FrameNumber, MarkerFrame);
+	
+	// The first Frame record after the marker is the end of the frame it was recorded in
+	for(int32 Index = MarkerIndex + 1; Index < Events.Num(); Index++) {
+		if(Events[Index].Type == ECombatEventType::Frame) {
+			Test->TestEqual(TEXT("Frame record that ends the marker's frame"), Events[Index].FrameNumber, MarkerFrame);
+			return true;
+		}
+	}
+	
+	Test->AddError(TEXT("No Frame record was written after the marker"));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCombatTelemetryFrameTest, "CMP302.Telemetry.FrameNumbers",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FCombatTelemetryFrameTest::RunTest(const FString& Parameters)
+{
+	// Only one recording can run at a time
+	if(FCombatTelemetry::IsRecording()) {
+		AddError(TEXT("Combat telemetry is already recording, stop it before running this test"));
+		return false;
+	}
+	
+	const FString Filename = FPaths::AutomationTransientDir() / TEXT("CombatTelemetryFrames.bin");
+	if(!FCombatTelemetry::StartRecording(Filename)) {
+		AddError(FString::Printf(TEXT("Couldn't record to %s"), *Filename));
+		return false;
+	}
+	
+	FCombatTelemetry::Record(ECombatEventType::PlayerShot, FVector::ZeroVector, MarkerObjectId);
+	
+	// Let a few frames end so their Frame records are written
+	ADD_LATENT_AUTOMATION_COMMAND(FEngineWaitLatentCommand(0.25f));
+	ADD_LATENT_AUTOMATION_COMMAND(FCheckTelemetryFramesCommand(this, Filename, static_cast<uint32>(GFrameCounter)));
+	
+	return true;
+}
+
+#endif
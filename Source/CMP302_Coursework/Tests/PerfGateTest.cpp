@@ -0,0 +1,164 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Tests/AutomationCommon.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "PerfGateSubsystem.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	UPerfGateSubsystem* FindPerfGate()
+	{
+		for(const FWorldContext& Context : GEngine->GetWorldContexts()) {
+			UWorld* World = Context.World();
+			if(World != nullptr && (Context.WorldType == EWorldType::Game || Context.WorldType == EWorldType::PIE))
+				return World->GetSubsystem<UPerfGateSubsystem>();
+		}
+		
+		return nullptr;
+	}
+}
+
+/** Starts one phase of the scenario and waits for it to finish */
+class FPerfGatePhaseCommand : public IAutomationLatentCommand
+{
+public:
+	explicit FPerfGatePhaseCommand(FAutomationTestBase* InTest)
+		: Test(InTest)
+	{
+	}
+
+	virtual bool Update() override
+	{
+		// An earlier phase failed, nothing left to measure
+		if(Test->HasAnyErrors())
+			return true;
+		
+		UPerfGateSubsystem* PerfGate = FindPerfGate();
+		if(PerfGate == nullptr) {
+			Test->AddError(TEXT("No game world to run the performance scenario in"));
+			return true;
+		}
+		
+		if(!bStarted) {
+			bStarted = true;
+			if(!StartPhase(*PerfGate))
+				return true;
+		}
+		
+		return !PerfGate->IsBusy();
+	}
+
+protected:
+	virtual bool StartPhase(UPerfGateSubsystem& PerfGate) = 0;
+
+	FAutomationTestBase* Test;
+
+private:
+	bool bStarted = false;
+};
+
+class FPerfGatePopulateCommand : public FPerfGatePhaseCommand
+{
+public:
+	using FPerfGatePhaseCommand::FPerfGatePhaseCommand;
+
+protected:
+	virtual bool StartPhase(UPerfGateSubsystem& PerfGate) override
+	{
+		if(PerfGate.StartPopulating(PerfGate.NumTurrets))
+			return true;
+		
+		Test->AddError(TEXT("Couldn't build the scenario, it needs a player character, a TurretClass and a WeaponClass"));
+		return false;
+	}
+};
+
+class FPerfGateWarmupCommand : public FPerfGatePhaseCommand
+{
+public:
+	using FPerfGatePhaseCommand::FPerfGatePhaseCommand;
+
+protected:
+	virtual bool StartPhase(UPerfGateSubsystem& PerfGate) override
+	{
+		PerfGate.StartWarmup();
+		return true;
+	}
+};
+
+class FPerfGateMeasureCommand : public FPerfGatePhaseCommand
+{
+public:
+	using FPerfGatePhaseCommand::FPerfGatePhaseCommand;
+
+protected:
+	virtual bool StartPhase(UPerfGateSubsystem& PerfGate) override
+	{
+		PerfGate.StartMeasuring();
+		return true;
+	}
+};
+
+/** Ends the scenario and fails the test for every budget it went over */
+DEFINE_LATENT_AUTOMATION_COMMAND_ONE_PARAMETER(FPerfGateCheckBudgetsCommand, FAutomationTestBase*, Test);
+
+bool FPerfGateCheckBudgetsCommand::Update()
+{
+	UPerfGateSubsystem* PerfGate = FindPerfGate();
+	if(PerfGate == nullptr || !PerfGate->IsRunning())
+		return true;
+	
+	// Always end the scenario so the turrets stop being driven, but a failed phase has nothing worth checking
+	const FPerfGateResult Result = PerfGate->Finish();
+	if(Test->HasAnyErrors())
+		return true;
+	
+	if(Result.NumFrames == 0)
+		Test->AddError(TEXT("No frames were measured"));
+	
+	if(!Result.bGrappling)
+		Test->AddError(TEXT("The grappling hook wasn't active, so the scenario isn't the reference one"));
+	
+	if(!Result.bAveragePassed)
+		Test->AddError(FString::Printf(TEXT("Average game thread time %.3f ms is over the %.3f ms budget"), Result.AverageGameThreadMs, PerfGate->MaxAverageGameThreadMs));
+	
+	if(!Result.bP99Passed)
+		Test->AddError(FString::Printf(TEXT("p99 game thread time %.3f ms is over the %.3f ms budget"), Result.P99GameThreadMs, PerfGate->MaxP99GameThreadMs));
+	
+	if(!Result.bSpawnsPassed)
+		Test->AddError(FString::Printf(TEXT("Peak of %d actor spawns in a frame is over the budget of %d"), Result.PeakSpawnsPerFrame, PerfGate->MaxSpawnsPerFrame));
+	
+	if(!Result.bMemoryPassed)
+		Test->AddError(FString::Printf(TEXT("Peak memory %.1f MB is over the %.1f MB budget"), Result.PeakMemoryMB, PerfGate->MaxPeakMemoryMB));
+	
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTurretBudgetTest, "CMP302.Perf.TurretBudget",
+	EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+bool FTurretBudgetTest::RunTest(const FString& Parameters)
+{
+	// Always the same map, so results can be compared between runs
+	const FString& ReferenceMap = GetDefault<UPerfGateSubsystem>()->ReferenceMap;
+	if(ReferenceMap.IsEmpty() || !AutomationOpenMap(ReferenceMap)) {
+		AddError(FString::Printf(TEXT("Couldn't open the reference map '%s'"), *ReferenceMap));
+		return false;
+	}
+	
+	// Give the player a moment to spawn and be possessed
+	ADD_LATENT_AUTOMATION_COMMAND(FEngineWaitLatentCommand(1.0f));
+	ADD_LATENT_AUTOMATION_COMMAND(FPerfGatePopulateCommand(this));
+	ADD_LATENT_AUTOMATION_COMMAND(FPerfGateWarmupCommand(this));
+	ADD_LATENT_AUTOMATION_COMMAND(FPerfGateMeasureCommand(this));
+	ADD_LATENT_AUTOMATION_COMMAND(FPerfGateCheckBudgetsCommand(this));
+	
+	return true;
+}
+
+#endif
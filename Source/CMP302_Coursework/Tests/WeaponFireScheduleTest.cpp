@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "TP_WeaponComponent.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	const float FrameRates[] = { 30.f, 60.f, 144.f, 240.f };
+	constexpr float InputBufferTime = 0.15f;
+	constexpr int32 BurstCount = 3;
+
+	struct FTriggerPress
+	{
+		float Time;
+		float HoldTime;
+	};
+
+	struct FScheduleRun
+	{
+		int32 NumShots = 0;
+		float MaxTimeSinceShot = 0.f;
+	};
+
+	/** Runs the schedule for Seconds at a fixed frame rate, pressing and releasing the trigger on the frames nearest each press */
+	FScheduleRun RunSchedule(EWeaponFireMode FireMode, float RoundsPerMinute, float FrameRate, float Seconds, const TArray<FTriggerPress>& Presses)
+	{
+		FWeaponFireSchedule Schedule;
+		FScheduleRun Run;
+		
+		const float DeltaSeconds = 1.f / FrameRate;
+		const int32 NumFrames = FMath::RoundToInt32(Seconds * FrameRate);
+		
+		for(int32 Frame = 0; Frame < NumFrames; Frame++) {
+			for(const FTriggerPress& Press : Presses) {
+				if(Frame == FMath::RoundToInt32(Press.Time * FrameRate))
+					Schedule.StartFiring(InputBufferTime);
+				
+				if(Frame == FMath::RoundToInt32((Press.Time + Press.HoldTime) * FrameRate))
+					Schedule.StopFiring();
+			}
+			
+			Run.NumShots += Schedule.Update(DeltaSeconds, FireMode, RoundsPerMinute, BurstCount, true, [&Run](float TimeSinceShot)
+			{
+				Run.MaxTimeSinceShot = FMath::Max(Run.MaxTimeSinceShot, TimeSinceShot);
+			});
+		}
+		
+		return Run;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWeaponFireScheduleFullAutoTest, "CMP302.Weapon.FireSchedule.FullAuto",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FWeaponFireScheduleFullAutoTest::RunTest(const FString& Parameters)
+{
+	// 600 RPM held for 2 seconds is a shot on press and one every 0.1 s after it
+	const TArray<FTriggerPress> Presses = { { 0.f, 2.f } };
+	const int32 ExpectedShots = 20;
+	
+	for(const float FrameRate : FrameRates) {
+		const FScheduleRun Run = RunSchedule(EWeaponFireMode::FullAuto, 600.f, FrameRate, 2.f, Presses);
+		
+		TestEqual(FString::Printf(TEXT("Shots at %.0f fps"), FrameRate), Run.NumShots, ExpectedShots);
+		TestTrue(FString::Printf(TEXT("Catch up shots at %.0f fps are at most a frame late"), FrameRate), Run.MaxTimeSinceShot <= 1.f / FrameRate + KINDA_SMALL_NUMBER);
+	}
+	
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWeaponFireScheduleBurstTest, "CMP302.Weapon.FireSchedule.Burst",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FWeaponFireScheduleBurstTest::RunTest(const FString& Parameters)
+{
+	// Taps and a long hold, each should fire exactly one burst
+	const TArray<FTriggerPress> Presses = { { 0.f, 0.f }, { 0.5f, 0.f }, { 1.f, 0.9f } };
+	
+	for(const float FrameRate : FrameRates) {
+		const FScheduleRun Run = RunSchedule(EWeaponFireMode::Burst, 600.f, FrameRate, 2.f, Presses);
+		
+		TestEqual(FString::Printf(TEXT("Shots at %.0f fps"), FrameRate), Run.NumShots, Presses.Num() * BurstCount);
+	}
+	
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWeaponFireScheduleSemiAutoTest, "CMP302.Weapon.FireSchedule.SemiAuto",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FWeaponFireScheduleSemiAutoTest::RunTest(const FString& Parameters)
+{
+	/**
+	 * At 120 RPM the weapon can fire every 0.5 s. The press at 0.4 s is
+	 * during the cooldown but inside the input buffer, so it fires at 0.5 s.
+	 * Holding the trigger from 1.2 s fires once, not once per interval.
+	 */
+	const TArray<FTriggerPress> Presses = { { 0.f, 0.f }, { 0.4f, 0.f }, { 1.2f, 1.5f } };
+	
+	for(const float FrameRate : FrameRates) {
+		const FScheduleRun Run = RunSchedule(EWeaponFireMode::SemiAuto, 120.f, FrameRate, 3.f, Presses);
+		
+		TestEqual(FString::Printf(TEXT("Shots at %.0f fps"), FrameRate), Run.NumShots, Presses.Num());
+	}
+	
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWeaponFireScheduleIdleTest, "CMP302.Weapon.FireSchedule.NoBankingWhenIdle",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FWeaponFireScheduleIdleTest::RunTest(const FString& Parameters)
+{
+	// Two holds of 0.5 s with a second of idle between them fire the same as two separate holds
+	const TArray<FTriggerPress> OneHold = { { 0.f, 0.5f } };
+	const TArray<FTriggerPress> TwoHolds = { { 0.f, 0.5f }, { 1.5f, 0.5f } };
+	
+	for(const float FrameRate : FrameRates) {
+		const FScheduleRun Single = RunSchedule(EWeaponFireMode::FullAuto, 600.f, FrameRate, 1.f, OneHold);
+		const FScheduleRun Double = RunSchedule(EWeaponFireMode::FullAuto, 600.f, FrameRate, 2.5f, TwoHolds);
+		
+		TestEqual(FString::Printf(TEXT("Shots at %.0f fps"), FrameRate), Double.NumShots, Single.NumShots * 2);
+		TestTrue(FString::Printf(TEXT("No shot at %.0f fps is more than a frame late"), FrameRate), Double.MaxTimeSinceShot <= 1.f / FrameRate + KINDA_SMALL_NUMBER);
+	}
+	
+	return true;
+}
+
+#endif
@@ -3,15 +3,23 @@
 
 #include "Turret.h"
 
+#include "CMP302_Coursework.h"
 #include "CMP302_CourseworkCharacter.h"
 #include "CMP302_CourseworkProjectile.h"
+#include "CombatTelemetry.h"
+#include "TurretDormancySubsystem.h"
+#include "TurretSoakSubsystem.h"
 #include "Kismet/GameplayStatics.h"
 
 #include "Engine/StaticMesh.h"
 
+const FName ATurret::ShootPositionName(TEXT("Shoot Position"));
+
 // Sets default values
 ATurret::ATurret()
 {
+	LLM_SCOPE_BYTAG(CMP302_Turrets);
+	
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 }
@@ -19,24 +27,131 @@ ATurret::ATurret()
 // Called when the game starts or when spawned
 void ATurret::BeginPlay()
 {
+	LLM_SCOPE_BYTAG(CMP302_Turrets);
+	
 	Super::BeginPlay();
 	
-	CharacterMovement = Cast<ACharacter>(UGameplayStatics::GetActorOfClass(GetWorld(), ACMP302_CourseworkCharacter::StaticClass()));
+	UTurretDormancySubsystem* Dormancy = GetWorld()->GetSubsystem<UTurretDormancySubsystem>();
+	FCombatTelemetry::Record(ECombatEventType::TurretSpawn, GetActorLocation(), GetUniqueID());
+	
+	if(Dormancy != nullptr) {
+		// Coming back from a streamed out cell, pick up where we left off
+		FTurretStateRecord Record;
+		if(Dormancy->ConsumeStreamedOutState(this, Record)) {
+			CharacterMovement = Dormancy->GetTarget();
+			RestoreState(Record);
+		}
+		
+		Dormancy->RegisterTurret(this);
+	}
+	
+	// Spawners can hand us the target up front so we don't scan the world per turret
+	if(CharacterMovement == nullptr)
+		CharacterMovement = Cast<ACharacter>(UGameplayStatics::GetActorOfClass(GetWorld(), ACMP302_CourseworkCharacter::StaticClass()));
+	
+	if(bHasMuzzleOffset)
+		return;
+	
+	// Components are outered to the actor, so this is a hash lookup rather than a string compare per component
+	if(ShootPosition == nullptr)
+		ShootPosition = FindObjectFast<UStaticMeshComponent>(this, ShootPositionName);
+	
+	if(ShootPosition != nullptr)
+		SetMuzzleOffset(GetActorTransform().InverseTransformPosition(ShootPosition->GetComponentLocation()));
+}
+
+void ATurret::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if(UTurretDormancySubsystem* Dormancy = GetWorld()->GetSubsystem<UTurretDormancySubsystem>())
+		Dormancy->UnregisterTurret(this, EndPlayReason);
+	
+	Super::EndPlay(EndPlayReason);
+}
+
+void ATurret::PreRegisterAllComponents()
+{
+	Super::PreRegisterAllComponents();
+	
+	HideCosmeticComponents();
+}
+
+void ATurret::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+	
+	// Spawned turrets only get their blueprint components during construction
+	HideCosmeticComponents();
+}
+
+void ATurret::HideCosmeticComponents() {
+	if(CMP302::ShouldPlayCosmetics(this))
+		return;
 	
-	for (UActorComponent* ChildComponent : GetComponents()) {
-		if(ChildComponent->GetName().Equals("Shoot Position")) {
-			ShootPosition = Cast<UStaticMeshComponent>(ChildComponent);
+	for (UActorComponent* Component : GetComponents()) {
+		if(UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>(Component)) {
+			Primitive->SetVisibility(false);
+			Primitive->SetCastShadow(false);
 		}
 	}
 }
 
+void ATurret::SetMuzzleOffset(const FVector& InMuzzleOffset) {
+	MuzzleOffset = InMuzzleOffset;
+	bHasMuzzleOffset = true;
+}
+
+FTurretStateRecord ATurret::CaptureState() const {
+	FTurretStateRecord Record;
+	Record.TurretClass = GetClass();
+	Record.Level = GetLevel();
+	Record.Location = FVector3f(GetActorLocation());
+	Record.Rotation = FRotator3f(GetActorRotation());
+	Record.Scale = FVector3f(GetActorScale3D());
+	Record.MuzzleOffset = FVector3f(MuzzleOffset);
+	Record.bHasMuzzleOffset = bHasMuzzleOffset;
+	Record.Timer = Timer;
+	
+	// Level designers tune these per turret, a respawned turret would otherwise get the class defaults
+	Record.FireSound = FireSound;
+	Record.CharacterMovement = CharacterMovement;
+	Record.FireRate = FireRate;
+	Record.RotationSpeed = RotationSpeed;
+	Record.LookAtDistance = LookAtDistance;
+	Record.ShootDistance = ShootDistance;
+	
+	return Record;
+}
+
+void ATurret::RestoreState(const FTurretStateRecord& Record) {
+	Timer = Record.Timer;
+	SetActorRotation(FRotator(Record.Rotation));
+	
+	FireSound = Record.FireSound;
+	FireRate = Record.FireRate;
+	RotationSpeed = Record.RotationSpeed;
+	LookAtDistance = Record.LookAtDistance;
+	ShootDistance = Record.ShootDistance;
+	
+	// Keep the target the restorer handed over if the captured one has gone
+	if(Record.CharacterMovement.IsValid())
+		CharacterMovement = Record.CharacterMovement.Get();
+	
+	if(Record.bHasMuzzleOffset)
+		SetMuzzleOffset(FVector(Record.MuzzleOffset));
+}
+
 // Called every frame
 void ATurret::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
+	
+	FTurretSoakScope SoakScope;
 
 	Timer += DeltaTime;
 	
+	if(CharacterMovement == nullptr)
+		return;
+	
 	FVector TargetLocation = CharacterMovement->GetTransform().GetLocation();
 	
 	float Distance = FVector::Distance(TargetLocation, GetTransform().GetLocation());
@@ -80,12 +195,18 @@ void ATurret::Fire(FRotator TargetDirection) {
 			//ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
 			
 			// Spawn the projectile at the muzzle
-			World->SpawnActor<ACMP302_CourseworkProjectile>(ProjectileClass, ShootPosition->GetComponentLocation(), TargetDirection, ActorSpawnParams);
+			LLM_SCOPE_BYTAG(CMP302_Projectiles);
+			const FVector MuzzleLocation = GetActorTransform().TransformPosition(MuzzleOffset);
+			World->SpawnActor<ACMP302_CourseworkProjectile>(ProjectileClass, MuzzleLocation, TargetDirection, ActorSpawnParams);
+			
+			FCombatTelemetry::Record(ECombatEventType::TurretShot, MuzzleLocation, GetUniqueID());
 		}
 	}
 	
+#if !UE_SERVER
 	// Try and play the sound if specified
-	if (FireSound != nullptr) {
+	if (FireSound != nullptr && CharacterMovement != nullptr && CMP302::ShouldPlayCosmetics(this)) {
 		UGameplayStatics::PlaySoundAtLocation(this, FireSound, CharacterMovement->GetActorLocation());
 	}
+#endif
 }
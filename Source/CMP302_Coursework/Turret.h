@@ -7,6 +7,44 @@
 #include "Turret.generated.h"
 
 class UStaticMesh;
+class USoundBase;
+class ACharacter;
+class ATurret;
+
+/**
+ * Turret state kept while a turret is dormant or streamed out, including
+ * the properties that can be edited per instance in the level
+ */
+USTRUCT()
+struct FTurretStateRecord
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TSubclassOf<ATurret> TurretClass;
+
+	/** Level the turret belongs to, so it can be restored into the same level */
+	TWeakObjectPtr<ULevel> Level;
+
+	FVector3f Location = FVector3f::ZeroVector;
+	FRotator3f Rotation = FRotator3f::ZeroRotator;
+	FVector3f Scale = FVector3f::OneVector;
+	FVector3f MuzzleOffset = FVector3f::ZeroVector;
+	float Timer = 0;
+	bool bHasMuzzleOffset = false;
+
+	UPROPERTY()
+	TObjectPtr<USoundBase> FireSound = nullptr;
+
+	TWeakObjectPtr<ACharacter> CharacterMovement;
+
+	float FireRate = 0;
+	float RotationSpeed = 0;
+	float LookAtDistance = 0;
+	float ShootDistance = 0;
+
+	FTransform GetTransform() const { return FTransform(FRotator(Rotation), FVector(Location), FVector(Scale)); }
+};
 
 UCLASS()
 class CMP302_COURSEWORK_API ATurret : public AActor
@@ -19,10 +57,37 @@ public:
 
 	void Fire(FRotator TargetDirection);
 
+	/** Sets the muzzle position in actor space, skipping the component lookup in BeginPlay */
+	void SetMuzzleOffset(const FVector& InMuzzleOffset);
+
+	bool HasMuzzleOffset() const { return bHasMuzzleOffset; }
+	const FVector& GetMuzzleOffset() const { return MuzzleOffset; }
+
+	/** Captures the state needed to bring this turret back after it is removed */
+	FTurretStateRecord CaptureState() const;
+
+	/** Restores captured state, must be called before BeginPlay to skip the setup lookups */
+	void RestoreState(const FTurretStateRecord& Record);
+
+	/** Name of the blueprint component projectiles are fired from */
+	static const FName ShootPositionName;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Called when the turret is destroyed or its level streams out
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Called before components placed in the level are registered
+	virtual void PreRegisterAllComponents() override;
+
+	// Called once the blueprint components have been created
+	virtual void OnConstruction(const FTransform& Transform) override;
+
+	/** Hides the meshes on dedicated servers so they keep their collision but never get a scene proxy */
+	void HideCosmeticComponents();
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -53,4 +118,9 @@ public:
 	
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Turret Properties",  meta = (AllowPrivateAccess = "true"))
 	float ShootDistance = 1000;
+
+private:
+	/** Muzzle location relative to the actor, resolved once from ShootPosition */
+	FVector MuzzleOffset = FVector::ZeroVector;
+	bool bHasMuzzleOffset = false;
 };
@@ -0,0 +1,203 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TurretDormancySubsystem.h"
+
+#include "CMP302_Coursework.h"
+#include "CMP302_CourseworkCharacter.h"
+#include "GameFramework/PlayerController.h"
+#include "Kismet/GameplayStatics.h"
+
+void UTurretDormancySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UTurretDormancySubsystem::OnLevelRemovedFromWorld);
+}
+
+void UTurretDormancySubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+	
+	Super::Deinitialize();
+}
+
+void UTurretDormancySubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	
+	RestoreQueuedTurrets();
+	
+	UpdateTimer += DeltaTime;
+	if(UpdateTimer < UpdateInterval)
+		return;
+	
+	UpdateTimer = 0;
+	
+	// Every player keeps the turrets around them awake
+	TArray<FVector> ViewLocations;
+	for(FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator) {
+		if(const APawn* Pawn = Iterator->Get()->GetPawn())
+			ViewLocations.Add(Pawn->GetActorLocation());
+	}
+	
+	// Nobody to measure against, leave everything as it is
+	if(ViewLocations.Num() == 0)
+		return;
+	
+	UpdateDormancy(ViewLocations);
+}
+
+TStatId UTurretDormancySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTurretDormancySubsystem, STATGROUP_Tickables);
+}
+
+void UTurretDormancySubsystem::RegisterTurret(ATurret* Turret)
+{
+	ActiveTurrets.AddUnique(Turret);
+}
+
+void UTurretDormancySubsystem::UnregisterTurret(ATurret* Turret, EEndPlayReason::Type EndPlayReason)
+{
+	ActiveTurrets.RemoveSwap(Turret);
+	
+	// Level or World Partition cell is unloading, and as the turret was loaded
+	// with it rather than spawned, the same actor will be loaded again later
+	if(EndPlayReason == EEndPlayReason::RemovedFromWorld && Turret->HasAnyFlags(RF_WasLoaded))
+		StreamedOutStates.Add(Turret->GetPathName(), Turret->CaptureState());
+}
+
+bool UTurretDormancySubsystem::ConsumeStreamedOutState(const ATurret* Turret, FTurretStateRecord& OutRecord)
+{
+	if(StreamedOutStates.Num() == 0)
+		return false;
+	
+	return StreamedOutStates.RemoveAndCopyValue(Turret->GetPathName(), OutRecord);
+}
+
+ACharacter* UTurretDormancySubsystem::GetTarget()
+{
+	// Found once and shared, so restored turrets don't each search the world for it
+	if(!Target.IsValid())
+		Target = Cast<ACharacter>(UGameplayStatics::GetActorOfClass(GetWorld(), ACMP302_CourseworkCharacter::StaticClass()));
+	
+	return Target.Get();
+}
+
+int32 UTurretDormancySubsystem::GetNumDormantTurrets() const
+{
+	int32 Count = PendingRestores.Num();
+	
+	for(const TPair<FIntPoint, FTurretDormantCell>& Pair : DormantCells)
+		Count += Pair.Value.Turrets.Num();
+	
+	return Count;
+}
+
+void UTurretDormancySubsystem::UpdateDormancy(const TArray<FVector>& ViewLocations)
+{
+	LLM_SCOPE_BYTAG(CMP302_Turrets);
+	
+	// Put to sleep any active turret whose cell is out of range.
+	// Going backwards as destroying the turret removes it from the array.
+	for(int32 Index = ActiveTurrets.Num() - 1; Index >= 0; Index--) {
+		ATurret* Turret = ActiveTurrets[Index];
+		if(!IsValid(Turret))
+			continue;
+		
+		const FIntPoint Cell = GetCell(Turret->GetActorLocation());
+		if(GetDistanceToCell(Cell, ViewLocations) <= DormancyRadius)
+			continue;
+		
+		DormantCells.FindOrAdd(Cell).Turrets.Add(Turret->CaptureState());
+		Turret->Destroy();
+	}
+	
+	// Wake up dormant cells that are back in range
+	const float WakeRadius = DormancyRadius - WakeHysteresis;
+	for(auto It = DormantCells.CreateIterator(); It; ++It) {
+		if(GetDistanceToCell(It.Key(), ViewLocations) > WakeRadius)
+			continue;
+		
+		PendingRestores.Append(It.Value().Turrets);
+		It.RemoveCurrent();
+	}
+}
+
+void UTurretDormancySubsystem::RestoreQueuedTurrets()
+{
+	if(PendingRestores.Num() == 0)
+		return;
+	
+	const int32 NumToRestore = FMath::Min(PendingRestores.Num(), MaxRestoresPerFrame);
+	for(int32 Index = 0; Index < NumToRestore; Index++)
+		RestoreTurret(PendingRestores[Index]);
+	
+	PendingRestores.RemoveAt(0, NumToRestore);
+}
+
+ATurret* UTurretDormancySubsystem::RestoreTurret(const FTurretStateRecord& Record)
+{
+	UWorld* const World = GetWorld();
+	if(World == nullptr || Record.TurretClass == nullptr)
+		return nullptr;
+	
+	LLM_SCOPE_BYTAG(CMP302_Turrets);
+	
+	const FTransform Transform = Record.GetTransform();
+	
+	FActorSpawnParameters ActorSpawnParams;
+	ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	ActorSpawnParams.OverrideLevel = Record.Level.Get();
+	ActorSpawnParams.bDeferConstruction = true;
+	
+	ATurret* Turret = World->SpawnActor<ATurret>(Record.TurretClass, Transform, ActorSpawnParams);
+	if(Turret == nullptr)
+		return nullptr;
+	
+	// Hand over everything BeginPlay would otherwise look up
+	Turret->CharacterMovement = GetTarget();
+	Turret->RestoreState(Record);
+	
+	Turret->FinishSpawning(Transform);
+	
+	return Turret;
+}
+
+FIntPoint UTurretDormancySubsystem::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+double UTurretDormancySubsystem::GetDistanceToCell(const FIntPoint& Cell, const TArray<FVector>& ViewLocations) const
+{
+	const FVector2D CellCenter = (FVector2D(Cell) + 0.5f) * CellSize;
+	
+	double Distance = TNumericLimits<double>::Max();
+	for(const FVector& ViewLocation : ViewLocations)
+		Distance = FMath::Min(Distance, FVector2D::Distance(CellCenter, FVector2D(ViewLocation)));
+	
+	return Distance;
+}
+
+void UTurretDormancySubsystem::OnLevelRemovedFromWorld(ULevel* Level, UWorld* World)
+{
+	if(World != GetWorld())
+		return;
+	
+	// Turrets placed in that level come back with it, so drop their dormant copies.
+	// A null level means the whole world is being torn down.
+	auto IsInRemovedLevel = [Level](const FTurretStateRecord& Record) {
+		return Level == nullptr || !Record.Level.IsValid() || Record.Level.Get() == Level;
+	};
+	
+	for(auto It = DormantCells.CreateIterator(); It; ++It) {
+		It.Value().Turrets.RemoveAllSwap(IsInRemovedLevel);
+		
+		if(It.Value().Turrets.Num() == 0)
+			It.RemoveCurrent();
+	}
+	
+	PendingRestores.RemoveAll(IsInRemovedLevel);
+}
@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Turret.h"
+#include "TurretDormancySubsystem.generated.h"
+
+class ACharacter;
+
+/** Turrets that went dormant together because their grid cell left the streaming radius */
+USTRUCT()
+struct FTurretDormantCell
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FTurretStateRecord> Turrets;
+};
+
+/**
+ * Keeps the number of live turrets bounded by the streaming radius.
+ * Turrets are grouped into grid cells, cells far from every player
+ * are reduced to compact state records and their turrets destroyed,
+ * and the turrets are respawned from those records when a player
+ * comes back. Turrets whose level or World Partition cell streams
+ * out keep their state the same way and restore it on stream in.
+ */
+UCLASS()
+class CMP302_COURSEWORK_API UTurretDormancySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// End of USubsystem interface
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+	/** Called by turrets from BeginPlay */
+	void RegisterTurret(ATurret* Turret);
+
+	/** Called by turrets from EndPlay, keeps their state if they are being streamed out */
+	void UnregisterTurret(ATurret* Turret, EEndPlayReason::Type EndPlayReason);
+
+	/** Returns the state the turret had when its level streamed out, if there is one */
+	bool ConsumeStreamedOutState(const ATurret* Turret, FTurretStateRecord& OutRecord);
+
+	/** Target handed to restored turrets in place of their BeginPlay lookup */
+	ACharacter* GetTarget();
+
+	UFUNCTION(BlueprintPure, Category="Turret Dormancy")
+	int32 GetNumActiveTurrets() const { return ActiveTurrets.Num(); }
+
+	UFUNCTION(BlueprintPure, Category="Turret Dormancy")
+	int32 GetNumDormantTurrets() const;
+
+public:
+	/** Size of the grid cells turrets are grouped into */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Turret Dormancy")
+	float CellSize = 4000;
+
+	/** Cells further than this from every player go dormant */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Turret Dormancy")
+	float DormancyRadius = 12000;
+
+	/** Cells wake up this much closer than DormancyRadius, so they don't flicker at the edge */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Turret Dormancy")
+	float WakeHysteresis = 2000;
+
+	/** How often cells are checked against the player positions */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Turret Dormancy")
+	float UpdateInterval = 0.5f;
+
+	/** Limit on turrets respawned per frame, so a whole cell waking doesn't hitch */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Turret Dormancy")
+	int32 MaxRestoresPerFrame = 16;
+
+private:
+	void UpdateDormancy(const TArray<FVector>& ViewLocations);
+	void RestoreQueuedTurrets();
+	ATurret* RestoreTurret(const FTurretStateRecord& Record);
+
+	FIntPoint GetCell(const FVector& Location) const;
+	double GetDistanceToCell(const FIntPoint& Cell, const TArray<FVector>& ViewLocations) const;
+
+	void OnLevelRemovedFromWorld(ULevel* Level, UWorld* World);
+
+	UPROPERTY()
+	TArray<TObjectPtr<ATurret>> ActiveTurrets;
+
+	UPROPERTY()
+	TMap<FIntPoint, FTurretDormantCell> DormantCells;
+
+	/** Records from cells that woke up, waiting to be respawned */
+	UPROPERTY()
+	TArray<FTurretStateRecord> PendingRestores;
+
+	/** State of turrets whose level streamed out, keyed by their path name */
+	UPROPERTY()
+	TMap<FString, FTurretStateRecord> StreamedOutStates;
+
+	FDelegateHandle LevelRemovedHandle;
+	TWeakObjectPtr<ACharacter> Target;
+	float UpdateTimer = 0;
+};
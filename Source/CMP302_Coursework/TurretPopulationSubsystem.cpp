@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TurretPopulationSubsystem.h"
+
+#include "Turret.h"
+#include "CMP302_Coursework.h"
+#include "CMP302_CourseworkCharacter.h"
+#include "Kismet/GameplayStatics.h"
+
+void UTurretPopulationSubsystem::PopulateTurrets(const TArray<FTurretSpawnRequest>& Requests)
+{
+	// Start a fresh batch once the previous one is done, otherwise append to it
+	if(!IsPopulating()) {
+		PendingRequests.Reset();
+		NextRequest = 0;
+		NumSpawned = 0;
+	}
+	
+	PendingRequests.Append(Requests);
+}
+
+void UTurretPopulationSubsystem::CancelPopulation()
+{
+	PendingRequests.Reset();
+	NextRequest = 0;
+}
+
+float UTurretPopulationSubsystem::GetProgress() const
+{
+	if(PendingRequests.Num() == 0)
+		return 1.0f;
+	
+	return static_cast<float>(NextRequest) / PendingRequests.Num();
+}
+
+void UTurretPopulationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	
+	if(!IsPopulating())
+		return;
+	
+	if(!Target.IsValid())
+		Target = Cast<ACharacter>(UGameplayStatics::GetActorOfClass(GetWorld(), ACMP302_CourseworkCharacter::StaticClass()));
+	
+	const double EndTime = FPlatformTime::Seconds() + FrameBudgetMs / 1000.0;
+	
+	do {
+		if(SpawnTurret(PendingRequests[NextRequest]) != nullptr)
+			NumSpawned++;
+		
+		NextRequest++;
+	} while(IsPopulating() && FPlatformTime::Seconds() < EndTime);
+	
+	OnProgress.Broadcast(NumSpawned, PendingRequests.Num());
+	
+	if(!IsPopulating())
+		OnComplete.Broadcast(NumSpawned);
+}
+
+TStatId UTurretPopulationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTurretPopulationSubsystem, STATGROUP_Tickables);
+}
+
+ATurret* UTurretPopulationSubsystem::SpawnTurret(const FTurretSpawnRequest& Request)
+{
+	UWorld* const World = GetWorld();
+	if(World == nullptr || Request.TurretClass == nullptr)
+		return nullptr;
+	
+	LLM_SCOPE_BYTAG(CMP302_Turrets);
+	
+	// Deferred so the cached state is in place before BeginPlay runs
+	ATurret* Turret = World->SpawnActorDeferred<ATurret>(Request.TurretClass, Request.Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if(Turret == nullptr)
+		return nullptr;
+	
+	Turret->CharacterMovement = Target.Get();
+	
+	const FVector* MuzzleOffset = MuzzleOffsets.Find(Request.TurretClass.Get());
+	if(MuzzleOffset != nullptr)
+		Turret->SetMuzzleOffset(*MuzzleOffset);
+	
+	Turret->FinishSpawning(Request.Transform);
+	
+	// First turret of this archetype looked the muzzle up itself, remember it for the rest
+	if(MuzzleOffset == nullptr && Turret->HasMuzzleOffset())
+		MuzzleOffsets.Add(Request.TurretClass.Get(), Turret->GetMuzzleOffset());
+	
+	return Turret;
+}
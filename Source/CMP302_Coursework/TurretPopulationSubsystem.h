@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TurretPopulationSubsystem.generated.h"
+
+class ATurret;
+class ACharacter;
+
+/** A single turret to place: which archetype and where */
+USTRUCT(BlueprintType)
+struct FTurretSpawnRequest
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Turret Population")
+	TSubclassOf<ATurret> TurretClass;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Turret Population")
+	FTransform Transform;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnTurretPopulationProgress, int32, NumSpawned, int32, NumRequested);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnTurretPopulationComplete, int32, NumSpawned);
+
+/**
+ * Spawns large numbers of turrets spread over several frames,
+ * staying within a per-frame time budget so big turret fields
+ * don't all run BeginPlay on the same frame.
+ */
+UCLASS()
+class CMP302_COURSEWORK_API UTurretPopulationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Queues turrets to be spawned over the next frames */
+	UFUNCTION(BlueprintCallable, Category="Turret Population")
+	void PopulateTurrets(const TArray<FTurretSpawnRequest>& Requests);
+
+	/** Drops any turrets that haven't been spawned yet */
+	UFUNCTION(BlueprintCallable, Category="Turret Population")
+	void CancelPopulation();
+
+	UFUNCTION(BlueprintPure, Category="Turret Population")
+	bool IsPopulating() const { return NextRequest < PendingRequests.Num(); }
+
+	/** Turrets spawned since the current batch started */
+	UFUNCTION(BlueprintPure, Category="Turret Population")
+	int32 GetNumSpawned() const { return NumSpawned; }
+
+	/** Fraction of the queued turrets spawned so far, 0 to 1 */
+	UFUNCTION(BlueprintPure, Category="Turret Population")
+	float GetProgress() const;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+public:
+	/** Time allowed for spawning each frame, at least one turret is always spawned */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Turret Population")
+	float FrameBudgetMs = 2.0f;
+
+	/** Called at the end of every frame that spawned turrets */
+	UPROPERTY(BlueprintAssignable, Category="Turret Population")
+	FOnTurretPopulationProgress OnProgress;
+
+	/** Called once every queued turret has been spawned */
+	UPROPERTY(BlueprintAssignable, Category="Turret Population")
+	FOnTurretPopulationComplete OnComplete;
+
+private:
+	ATurret* SpawnTurret(const FTurretSpawnRequest& Request);
+
+	TArray<FTurretSpawnRequest> PendingRequests;
+	int32 NextRequest = 0;
+	int32 NumSpawned = 0;
+
+	/** Muzzle offset per archetype, found from the first turret of each class */
+	UPROPERTY()
+	TMap<TObjectPtr<UClass>, FVector> MuzzleOffsets;
+
+	/** Shared target so each turret doesn't have to search the world for it */
+	TWeakObjectPtr<ACharacter> Target;
+};
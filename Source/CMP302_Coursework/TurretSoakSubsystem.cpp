@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TurretSoakSubsystem.h"
+
+#include "CMP302_Coursework.h"
+#include "GameplayMemoryReport.h"
+#include "Turret.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+
+uint64 UTurretSoakSubsystem::TurretTickCycles = 0;
+uint64 UTurretSoakSubsystem::NumTurretTicks = 0;
+bool UTurretSoakSubsystem::bSoakActive = false;
+
+static FAutoConsoleCommandWithWorldAndArgs TurretSoakCommand(
+	TEXT("CMP302.TurretSoak"),
+	TEXT("Measures turret CPU and memory for the given number of seconds (default 30) and logs a report."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr)
+		{
+			return;
+		}
+
+		if (UTurretSoakSubsystem* Soak = World->GetSubsystem<UTurretSoakSubsystem>())
+		{
+			Soak->StartSoak(Args.Num() > 0 ? FCString::Atof(*Args[0]) : 30.0f);
+		}
+	}));
+
+void UTurretSoakSubsystem::StartSoak(float Duration)
+{
+	bSoaking = true;
+	bSoakActive = true;
+	RemainingTime = Duration;
+	ElapsedTime = 0;
+	NumFrames = 0;
+	PeakUsedPhysical = 0;
+	
+	TurretTickCycles = 0;
+	NumTurretTicks = 0;
+	
+	UE_LOG(LogCMP302, Display, TEXT("Turret soak started for %.1f seconds"), Duration);
+}
+
+void UTurretSoakSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	
+	if(!bSoaking)
+		return;
+	
+	NumFrames++;
+	ElapsedTime += DeltaTime;
+	PeakUsedPhysical = FMath::Max<uint64>(PeakUsedPhysical, FPlatformMemory::GetStats().UsedPhysical);
+	
+	RemainingTime -= DeltaTime;
+	if(RemainingTime > 0)
+		return;
+	
+	bSoaking = false;
+	bSoakActive = false;
+	Report();
+	
+	if(FParse::Param(FCommandLine::Get(), TEXT("unattended")))
+		FPlatformMisc::RequestExit(false);
+}
+
+void UTurretSoakSubsystem::Deinitialize()
+{
+	if(bSoaking)
+		bSoakActive = false;
+	
+	Super::Deinitialize();
+}
+
+TStatId UTurretSoakSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTurretSoakSubsystem, STATGROUP_Tickables);
+}
+
+void UTurretSoakSubsystem::Report()
+{
+	// Memory held by each turret and its components, which is what stripping cosmetics changes
+	int32 NumTurrets = 0;
+	uint64 TurretBytes = 0;
+	for(TActorIterator<ATurret> It(GetWorld()); It; ++It) {
+		NumTurrets++;
+		TurretBytes += CMP302::GetInstanceBytes(*It);
+		
+		for(const UActorComponent* Component : It->GetComponents())
+			TurretBytes += CMP302::GetInstanceBytes(Component);
+	}
+	
+	const double TurretMs = FPlatformTime::ToMilliseconds64(TurretTickCycles);
+	const double MicrosecondsPerTurretTick = NumTurretTicks > 0 ? TurretMs * 1000.0 / NumTurretTicks : 0.0;
+	
+	UE_LOG(LogCMP302, Display, TEXT("TurretSoak mode=%s nullrhi=%d frames=%d seconds=%.2f avg_frame_ms=%.3f turrets=%d turret_tick_us=%.3f turret_ms_per_frame=%.3f bytes_per_turret=%llu peak_used_physical_mb=%.1f"),
+		CMP302::ShouldPlayCosmetics(this) ? TEXT("client") : TEXT("server"),
+		FApp::CanEverRender() ? 0 : 1,
+		NumFrames,
+		ElapsedTime,
+		NumFrames > 0 ? ElapsedTime * 1000.0 / NumFrames : 0.0,
+		NumTurrets,
+		MicrosecondsPerTurretTick,
+		NumFrames > 0 ? TurretMs / NumFrames : 0.0,
+		NumTurrets > 0 ? TurretBytes / NumTurrets : 0ull,
+		PeakUsedPhysical / (1024.0 * 1024.0));
+}
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TurretSoakSubsystem.generated.h"
+
+/**
+ * Measures what turrets cost while the game runs, started with
+ * "CMP302.TurretSoak <Seconds>". Run it once on a dedicated server
+ * and once on a client, both with -nullrhi, to compare the two:
+ *
+ *   UnrealEditor-Cmd CMP302_Coursework -server -nullrhi -unattended -ExecCmds="CMP302.TurretSoak 60"
+ *   UnrealEditor-Cmd CMP302_Coursework -game -nullrhi -unattended -ExecCmds="CMP302.TurretSoak 60"
+ *
+ * The report is a single key=value line, and with -unattended the
+ * game exits once it has been written.
+ */
+UCLASS()
+class CMP302_COURSEWORK_API UTurretSoakSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Starts measuring for the given number of seconds */
+	void StartSoak(float Duration);
+
+	// USubsystem interface
+	virtual void Deinitialize() override;
+	// End of USubsystem interface
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+public:
+	/** Time spent in turret ticks, added to by FTurretSoakScope while a soak is running */
+	static uint64 TurretTickCycles;
+	static uint64 NumTurretTicks;
+	static bool bSoakActive;
+
+private:
+	void Report();
+
+	bool bSoaking = false;
+	float RemainingTime = 0;
+	float ElapsedTime = 0;
+	int32 NumFrames = 0;
+	uint64 PeakUsedPhysical = 0;
+};
+
+/** Adds the time spent in its scope to the turret soak counters, does nothing outside a soak */
+struct FTurretSoakScope
+{
+	FTurretSoakScope()
+		: StartCycles(UTurretSoakSubsystem::bSoakActive ? FPlatformTime::Cycles64() : 0)
+	{
+	}
+
+	~FTurretSoakScope()
+	{
+		if(StartCycles != 0)
+		{
+			UTurretSoakSubsystem::TurretTickCycles += FPlatformTime::Cycles64() - StartCycles;
+			UTurretSoakSubsystem::NumTurretTicks++;
+		}
+	}
+
+	uint64 StartCycles;
+};